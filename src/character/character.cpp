@@ -100,13 +100,14 @@ void Character::parse()
 
             util::compute_rank_destructive(num_qubit_, (num_qubit_ - num_ancilla_) + num_hadamard_, wires);
             int index = 0;
+            new_hadamard.in_.resize(phase_exponents_.size());
             for (const auto& phase_exponent : phase_exponents_)
             {
                 if (phase_exponent.first != 0)
                 {
                     if (util::is_independent((num_qubit_ - num_ancilla_) + num_hadamard_, wires, phase_exponent.second))
                     {
-                        new_hadamard.in_.insert(index);
+                        new_hadamard.in_.set(index);
                     }
                 }
                 index++;
@@ -137,6 +138,12 @@ void Character::parse()
     }
 
     outputs_ = std::move(wires);
+
+    // every index set ranges over all phase exponents
+    for (auto&& hadamard : hadamards_)
+    {
+        hadamard.in_.resize(phase_exponents_.size());
+    }
 }
 
 }
\ No newline at end of file
@@ -22,7 +22,7 @@ public:
         int target_;
         int previous_qubit_index_;
         std::vector<util::xor_func> input_wires_parity_;
-        std::set<int> in_;
+        util::index_set in_;
 
         Hadamard() { }
 
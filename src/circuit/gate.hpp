@@ -15,6 +15,8 @@ private:
     std::vector<std::string> control_list_;
     std::vector<std::string> target_list_;
 
+    int layer_ = -1; // id of the parallel layer the gate belongs to, -1: none
+
 public:
     /**
      * constructor
@@ -122,6 +124,25 @@ public:
         return target_list_;
     }
 
+    /**
+     * return the parallel layer of the gate
+     * consecutive gates of the same layer act on disjoint qubits and run in one step
+     * @return layer id, -1 if the gate is not part of a layer
+     */
+    int layer() const
+    {
+        return layer_;
+    }
+
+    /**
+     * set the parallel layer of the gate
+     * @param layer layer id
+     */
+    void set_layer(int layer)
+    {
+        layer_ = layer;
+    }
+
     /**
      * print gate status
      */
@@ -68,4 +68,64 @@ std::list<Gate> GaussianDecomposer::execute(std::vector<util::xor_func>& matrix,
     return lst;
 }
 
+int GaussianDecomposer::count_gates(std::vector<util::xor_func>& matrix)
+{
+    int count = 0;
+
+    for (int j = 0; j < n(); j++)
+    {
+        if (matrix[j].test(n()))
+        {
+            matrix[j].reset(n());
+            count++;
+        }
+    }
+
+    // Make triangular
+    for (int i = 0; i < n(); i++)
+    {
+        bool flg = false;
+        for (int j = i; j < n() + m(); j++)
+        {
+            if (matrix[j].test(i))
+            {
+                if (!flg)
+                {
+                    if (j != i)
+                    {
+                        std::swap(matrix[i], matrix[j]);
+                    }
+                    flg = true;
+                }
+                else
+                {
+                    matrix[j] ^= matrix[i];
+                    count++;
+                }
+            }
+        }
+        if (!flg)
+        {
+            std::cerr << "ERROR: not full rank" << std::endl;
+
+            exit(1);
+        }
+    }
+
+    //Finish the job
+    for (int i = n() - 1; i > 0; i--)
+    {
+        for (int j = i - 1; j >= 0; j--)
+        {
+            if (matrix[j].test(i))
+            {
+                matrix[j] ^= matrix[i];
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
 }
\ No newline at end of file
@@ -7,7 +7,7 @@
 
 namespace tskd {
 
-class GaussianDecomposer : public MatrixDecomposer
+class GaussianDecomposer final : public MatrixDecomposer
 {
 private:
 
@@ -24,6 +24,13 @@ public:
 
     std::list<Gate> execute(std::vector<util::xor_func>& matrix,
                             std::vector<int>& func_map) final;
+
+    int count_gates(std::vector<util::xor_func>& matrix) final;
+
+    int estimate_gates(std::vector<util::xor_func>& matrix) final
+    {
+        return count_gates(matrix);
+    }
 };
 
 }
@@ -53,13 +53,34 @@ public:
         return m_;
     }
 
-    std::vector<std::string> qubit_names() const
+    const std::vector<std::string>& qubit_names() const
     {
         return qubit_names_;
     }
 
     virtual std::list<Gate> execute(std::vector<util::xor_func>& matrix,
                                     std::vector<int>& func_map) = 0;
+
+    /**
+     * count the steps of the gates execute() would return, without generating them (destructive)
+     * a layer of gates tagged with one layer id takes one step
+     * @param matrix parity matrix
+     * @return number of steps, or -1, leaving the matrix intact, when it has to be decomposed to know it
+     */
+    virtual int count_gates(std::vector<util::xor_func>& matrix)
+    {
+        return -1;
+    }
+
+    /**
+     * cheap lower bound on the steps of the gates execute() would return (destructive)
+     * @param matrix parity matrix
+     * @return lower bound
+     */
+    virtual int estimate_gates(std::vector<util::xor_func>& matrix)
+    {
+        return 0;
+    }
 };
 
 }
@@ -1,172 +1,255 @@
-#include <map>
-#include <unordered_map>
+#include <atomic>
+#include <iterator>
+#include <algorithm>
 
 #include "parallel_decomposer.hpp"
 
-#include "../parallel/parallelization_oracle.hpp"
-
 namespace tskd {
 
-static void update_gate_set_list(const int sign,
-                                 const int pivot,
-                                 const std::vector<int>& one_array,
-                                 std::unordered_map<std::string, int>& depth,
-                                 std::vector<std::list<Gate>>& gate_set_list,
-                                 const std::vector<std::string>& qubit_names,
-                                 ParallelizationOracle& oracle)
+ParallelDecomposer::State& ParallelDecomposer::thread_state()
+{
+    return state_.get([this]() {
+        return std::unique_ptr<State>(new State(oracle_, qubit_names()));
+    });
+}
+
+void ParallelDecomposer::place(State& state,
+                               const int control,
+                               std::vector<GateLayer>& layer_list)
 {
+    const int num_target = static_cast<int>(state.target_list.size());
+    const int start = state.target_layer[control] + 1;
+
     /*
-     * Init depth of each qubit
+     * bucket the targets by the first layer they may join, keeping their
+     * order within a bucket
      */
-    auto l = [](int lhs, int rhs){return lhs < rhs;};
-    auto g = [](int lhs, int rhs){return lhs > rhs;};
-    auto comp = sign ? g : l;
-    std::map<int, std::vector<int>> depth_bit_map; // <depth, qubit_index>
-    depth_bit_map.emplace(depth[qubit_names[pivot]], std::vector<int>(1, pivot));
-    for (auto&& o : one_array)
+    int last = start;
+    state.ready.resize(num_target);
+    for (int p = 0; p < num_target; p++)
     {
-        const int bit_depth = depth[qubit_names[o]];
-        if (depth_bit_map.count(bit_depth))
-        {
-            depth_bit_map[bit_depth].push_back(o);
-        }
-        else
-        {
-            depth_bit_map.emplace(bit_depth, std::vector<int>(1, o));
-        }
+        state.ready[p] = std::max(start, state.control_layer[state.target_list[p]] + 1);
+        last = std::max(last, state.ready[p]);
+    }
+    state.count.assign(last - start + 2, 0);
+    for (int p = 0; p < num_target; p++)
+    {
+        state.count[state.ready[p] - start + 1]++;
+    }
+    for (size_t i = 1; i < state.count.size(); i++)
+    {
+        state.count[i] += state.count[i - 1];
+    }
+    state.queue.resize(num_target);
+    for (int p = 0; p < num_target; p++)
+    {
+        state.queue[state.count[state.ready[p] - start]++] = p;
     }
 
     /*
-     * generate cnot gate
+     * from the first layer on, the ready targets in list order join the
+     * layer while it can route them; the others wait for the next one
      */
-    std::vector<int> carry_bit_set;
-    for (auto it = depth_bit_map.begin(); it != depth_bit_map.end(); it++)
+    int head = 0;
+    state.pending.clear();
+    for (int index = start; head < num_target || !state.pending.empty(); index++)
     {
-        const int bit_depth = it->first;
-        std::vector<int> bit_set = it->second;
-
-        // carry move process
-        for (auto&& carry : carry_bit_set)
+        while (static_cast<int>(layer_list.size()) <= index)
         {
-            const std::string carry_qubit_name = qubit_names[carry];
-            depth[carry_qubit_name] = bit_depth;
+            layer_list.emplace_back();
+            state.busy.resize(layer_list.size() * n(), false);
         }
-        bit_set.insert(bit_set.end(), carry_bit_set.begin(), carry_bit_set.end());
-        carry_bit_set.clear();
-
 
-        if (bit_set.size() == 1)
+        int tail = head;
+        while (tail < num_target && state.ready[state.queue[tail]] <= index)
+        {
+            tail++;
+        }
+        if (tail > head)
         {
-            carry_bit_set.push_back(bit_set.front());
+            state.merged.clear();
+            std::merge(state.pending.begin(), state.pending.end(),
+                       state.queue.begin() + head, state.queue.begin() + tail,
+                       std::back_inserter(state.merged));
+            state.pending.swap(state.merged);
+            head = tail;
+        }
+        if (state.pending.empty())
+        {
+            // skip to the next bucket
+            index = state.ready[state.queue[head]] - 1;
 
             continue;
         }
+        if (state.busy[index * n() + control])
+        {
+            continue;
+        }
 
-        std::sort(bit_set.begin(), bit_set.end(), comp);
+        state.probe.clear();
+        state.rest.clear();
+        for (auto&& p : state.pending)
+        {
+            const int target = state.target_list[p];
+            if (!state.busy[index * n() + target])
+            {
+                state.probe.push_back(target);
+                if (state.scheduler.check(layer_list[index], index, control, state.probe))
+                {
+                    state.busy[index * n() + target] = true;
+                    state.target_layer[target] = std::max(state.target_layer[target], index);
 
-        /*
-         * Search for gates that can be parallelized
-         */
-        for (size_t i = 0; i < bit_set.size(); i++)
+                    continue;
+                }
+                state.probe.pop_back();
+            }
+            state.rest.push_back(p);
+        }
+
+        if (!state.probe.empty())
         {
-            if (bit_set[i] == -1)
+            std::vector<std::string> name_list;
+            for (auto&& target : state.probe)
             {
-                continue;
+                name_list.push_back(qubit_names()[target]);
             }
+            layer_list[index].emplace_back("tof", qubit_names()[control], name_list);
+            state.scheduler.commit(index);
+            state.busy[index * n() + control] = true;
+            state.control_layer[control] = std::max(state.control_layer[control], index);
+        }
+        state.pending.swap(state.rest);
+    }
+}
 
-            const std::string control = qubit_names[bit_set[i]];
-            std::vector<std::string> target_list;
-            std::vector<Gate> candidates;
+std::list<Gate> ParallelDecomposer::lower(const std::vector<GateLayer>& layer_list)
+{
+    // ids only have to differ between neighbouring layers, also across calls
+    static std::atomic<int> next_layer(0);
 
-            for (size_t j = i + 1; j < bit_set.size(); j++)
+    /*
+     * one cnot per pair, the layers from the last as execute() lists gates
+     */
+    std::list<Gate> ret;
+    for (auto&& layer : layer_list)
+    {
+        const int id = next_layer++;
+        for (auto&& gate : layer)
+        {
+            for (auto&& target : gate.target_list())
             {
-                if (bit_set[j] == -1)
-                {
-                    continue;
-                }
+                ret.emplace_front("cnot", gate.control_list().front(), target);
+                ret.front().set_layer(id);
+            }
+        }
+    }
 
-                const std::string candidate_target = qubit_names[bit_set[j]];
-                target_list.push_back(candidate_target);
-                const Gate new_gate("tof", control, target_list);
+    return ret;
+}
 
-                if (oracle.check(gate_set_list[bit_depth], new_gate))
+std::vector<GateLayer> ParallelDecomposer::schedule(std::vector<util::xor_func>& matrix,
+                                                    std::vector<int>& func_map)
+{
+    State& state = thread_state();
+    std::vector<GateLayer> layer_list;
+    state.control_layer.assign(n(), -1);
+    state.target_layer.assign(n(), -1);
+    state.busy.clear();
+    state.scheduler.clear();
+
+    // Make triangular
+    std::vector<int>& target_list = state.target_list;
+    for (int i = 0; i < n(); i++)
+    {
+        bool flg = false;
+        target_list.clear();
+        for (int j = i; j < n() + m(); j++)
+        {
+            if (matrix[j].test(i))
+            {
+                // If we haven't yet seen a vector with bit i set...
+                if (!flg)
                 {
-                    bit_set[j] = -1;
-                    depth[candidate_target]++;
-                    candidates.push_back(new_gate);
+                    // If it wasn't the first vector we tried, swap to the front
+                    if (j != i)
+                    {
+                        swap(matrix[i], matrix[j]);
+                        std::swap(func_map[i], func_map[j]);
+                    }
+                    flg = true;
                 }
                 else
                 {
-                    target_list.pop_back();
+                    matrix[j] ^= matrix[i];
+                    target_list.push_back(func_map[j]);
                 }
             }
+        }
+        if (!flg)
+        {
+            std::cerr << "ERROR: not full rank" << std::endl;
 
-            if (!candidates.empty())
-            {
-                gate_set_list[bit_depth].push_back(candidates.back());
-            }
+            exit(1);
         }
 
-        for (auto&& bit : bit_set)
+        place(state, func_map[i], layer_list);
+    }
+
+    //Finish the job
+    for (int i = n() - 1; i > 0; i--)
+    {
+        target_list.clear();
+        for (int j = i - 1; j >= 0; j--)
         {
-            if (bit != -1)
+            if (matrix[j].test(i))
             {
-                const std::string qubit_name = qubit_names[bit];
-                depth[qubit_name]++;
-                carry_bit_set.push_back(bit);
+                matrix[j] ^= matrix[i];
+                target_list.push_back(func_map[j]);
             }
         }
 
-        if (carry_bit_set.size() >= 2 && std::next(it) == depth_bit_map.end())
-        {
-            const int next_bit_depth = bit_depth + 1;
-            depth_bit_map.insert(std::make_pair(next_bit_depth, std::vector<int>()));
-        }
+        place(state, func_map[i], layer_list);
     }
+
+    // a fan-out may leave an empty layer behind when its last targets fit earlier ones
+    layer_list.erase(std::remove_if(layer_list.begin(), layer_list.end(),
+                                    [](const GateLayer& layer) { return layer.empty(); }),
+                     layer_list.end());
+
+    return layer_list;
 }
 
-static std::list<Gate> generate_gate_list(const std::vector<std::list<Gate>>& gate_set_list)
+std::list<Gate> ParallelDecomposer::execute(std::vector<util::xor_func>& matrix,
+                                            std::vector<int>& func_map)
 {
     std::list<Gate> ret;
 
-    if (gate_set_list.empty())
-    {
-        return ret;
-    }
-
-    for (auto&& gate_group : gate_set_list)
+    for (int j = 0; j < n(); j++)
     {
-        if (gate_group.empty()) break;
-
-        if (gate_group.size() >= 2)
-        {
-            ret.emplace_front("cnot");
-        }
-        else
+        if (matrix[j].test(n()))
         {
-            ret.emplace_front(gate_group.front());
+            matrix[j].reset(n());
+            ret.splice(ret.begin(), util::compose_x(j, qubit_names()));
         }
     }
 
+    ret.splice(ret.begin(), lower(schedule(matrix, func_map)));
+
     return ret;
 }
 
-std::list<Gate> ParallelDecomposer::execute(std::vector<util::xor_func>& matrix,
-                                            std::vector<int>& func_map)
+int ParallelDecomposer::estimate_gates(std::vector<util::xor_func>& matrix)
 {
-    constexpr int swap_step = 3;
-    constexpr int cnot_step = 1;
-    const int max_num_gate = (swap_step + cnot_step) * (2 * matrix.size());
-    std::list<Gate> ret;
-    std::unordered_map<std::string, int> depth;
-    std::vector<std::list<Gate>> gate_set_list(max_num_gate);
-
-    ParallelizationOracle oracle(layout());
-
-    // init
-    for (auto&& name : qubit_names())
+    /*
+     * a qubit is the target of at most one cnot per layer, so the layers are
+     * at least the largest number of cnots sharing a target
+     */
+    int num_x = 0;
+    std::vector<int> target_count(matrix.size(), 0);
+    std::vector<int> func_map(matrix.size());
+    for (size_t i = 0; i < matrix.size(); i++)
     {
-        depth.emplace(name, 0);
+        func_map[i] = static_cast<int>(i);
     }
 
     for (int j = 0; j < n(); j++)
@@ -174,27 +257,23 @@ std::list<Gate> ParallelDecomposer::execute(std::vector<util::xor_func>& matrix,
         if (matrix[j].test(n()))
         {
             matrix[j].reset(n());
-            ret.splice(ret.begin(), util::compose_x(j, qubit_names()));
+            num_x++;
         }
     }
 
     // Make triangular
-    std::vector<int> one_array(static_cast<int>(matrix.size()));
     for (int i = 0; i < n(); i++)
     {
         bool flg = false;
-        one_array.clear();
         for (int j = i; j < n() + m(); j++)
         {
-
             if (matrix[j].test(i))
             {
-                // If we haven't yet seen a vector with bit i set...
-                if (!flg) {
-                    // If it wasn't the first vector we tried, swap to the front
+                if (!flg)
+                {
                     if (j != i)
                     {
-                        swap(matrix[i], matrix[j]);
+                        std::swap(matrix[i], matrix[j]);
                         std::swap(func_map[i], func_map[j]);
                     }
                     flg = true;
@@ -202,7 +281,7 @@ std::list<Gate> ParallelDecomposer::execute(std::vector<util::xor_func>& matrix,
                 else
                 {
                     matrix[j] ^= matrix[i];
-                    one_array.push_back(func_map[j]);
+                    target_count[func_map[j]]++;
                 }
             }
         }
@@ -212,32 +291,22 @@ std::list<Gate> ParallelDecomposer::execute(std::vector<util::xor_func>& matrix,
 
             exit(1);
         }
-
-        // generate candidate cnot list
-        update_gate_set_list(0, func_map[i], one_array, depth, gate_set_list, qubit_names(), oracle);
     }
 
     //Finish the job
     for (int i = n() - 1; i > 0; i--)
     {
-        one_array.clear();
         for (int j = i - 1; j >= 0; j--)
         {
             if (matrix[j].test(i))
             {
                 matrix[j] ^= matrix[i];
-                one_array.push_back(func_map[j]);
+                target_count[func_map[j]]++;
             }
         }
-
-        // generate candidate cnot list
-        update_gate_set_list(1, func_map[i], one_array, depth, gate_set_list, qubit_names(), oracle);
     }
 
-    // add gate
-    ret.splice(ret.end(), generate_gate_list(gate_set_list));
-
-    return ret;
+    return num_x + *std::max_element(target_count.begin(), target_count.end());
 }
 
 }
\ No newline at end of file
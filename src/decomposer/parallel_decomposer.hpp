@@ -1,15 +1,77 @@
 #ifndef T_SCHEDULING_PARALLEL_DECOMPOSER_HPP
 #define T_SCHEDULING_PARALLEL_DECOMPOSER_HPP
 
+#include <list>
+#include <vector>
+
 #include "matrix_decomposer.hpp"
 
 #include "../layout/layout.hpp"
 
+#include "../util/per_thread.hpp"
+
+#include "../parallel/routing_scheduler.hpp"
+#include "../parallel/parallelization_oracle.hpp"
+
 namespace tskd {
 
-class ParallelDecomposer : public MatrixDecomposer
+using GateLayer = std::list<Gate>; // multi-target cnots on disjoint qubits, run in one step
+
+/**
+ * gaussian elimination whose row operations are grouped into parallel layers
+ * the row additions of a pivot form one multi-target cnot; each pair of it is
+ * placed in the earliest layer after the pairs it does not commute with, where
+ * its qubits are free and the layer can still be routed on the layout
+ */
+class ParallelDecomposer final : public MatrixDecomposer
 {
 private:
+    /**
+     * state of schedule() for one thread, indexed by wire, and scratch kept
+     * across calls
+     */
+    struct State
+    {
+        RoutingScheduler scheduler;
+
+        std::vector<int> control_layer; // [wire] last layer the wire is a control in
+        std::vector<int> target_layer;  // [wire] last layer the wire is a target in
+        std::vector<char> busy;         // [layer * n + wire] the wire is used in the layer
+
+        std::vector<int> target_list;   // targets of the current pivot
+        std::vector<int> ready;         // [position] first layer the target may join
+        std::vector<int> count;         // bucket offsets
+        std::vector<int> queue;         // positions by ready layer
+        std::vector<int> pending;       // ready positions not placed yet, in list order
+        std::vector<int> merged;
+        std::vector<int> rest;
+        std::vector<int> probe;         // targets of the gate being built
+
+        State(const ParallelizationOracle& oracle,
+              const std::vector<std::string>& qubit_names)
+                : scheduler(oracle, qubit_names) { }
+    };
+
+    ParallelizationOracle oracle_;
+
+    util::PerThread<State> state_; // execute() may run in several builder threads at once
+
+    State& thread_state();
+
+    /**
+     * place the multi-target cnot of a pivot in the layers
+     * a pair (control, target) follows the gates that target its control or
+     * are controlled by its target; the targets that do not fit a layer move on
+     * to the next
+     * @param state state of the thread
+     * @param control control wire
+     * @param layer_list layers
+     */
+    void place(State& state,
+               int control,
+               std::vector<GateLayer>& layer_list);
+
+    static std::list<Gate> lower(const std::vector<GateLayer>& layer_list);
 
 public:
     ParallelDecomposer() = default;
@@ -18,12 +80,24 @@ public:
                        const int n,
                        const int m,
                        const std::vector<std::string>& qubit_names)
-            : MatrixDecomposer(layout, n, m, qubit_names) { }
+            : MatrixDecomposer(layout, n, m, qubit_names),
+              oracle_(layout) { }
 
     ~ParallelDecomposer() final = default;
 
+    /**
+     * schedule the gates of the inverse of matrix in layers (destructive)
+     * @param matrix parity matrix without affine bits
+     * @param func_map [i] = wire the function of row i ends on
+     * @return layers in circuit order
+     */
+    std::vector<GateLayer> schedule(std::vector<util::xor_func>& matrix,
+                                    std::vector<int>& func_map);
+
     std::list<Gate> execute(std::vector<util::xor_func>& matrix,
                             std::vector<int>& func_map) final;
+
+    int estimate_gates(std::vector<util::xor_func>& matrix) final;
 };
 
 }
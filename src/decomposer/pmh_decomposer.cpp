@@ -0,0 +1,181 @@
+#include <cmath>
+#include <algorithm>
+#include <unordered_map>
+
+#include "pmh_decomposer.hpp"
+
+#include "../util/util.hpp"
+
+namespace tskd {
+
+int PMHDecomposer::section_size() const
+{
+    return std::max(1, static_cast<int>(std::round(std::log2(std::max(2, n())) / 2)));
+}
+
+void PMHDecomposer::eliminate_lower(std::vector<util::xor_func>& matrix,
+                                    std::vector<int>* func_map,
+                                    std::vector<cnot>& cnot_list) const
+{
+    const int section = section_size();
+    auto wire = [&](int row) { return func_map != nullptr ? (*func_map)[row] : row; };
+    std::unordered_map<unsigned long, int> pattern_map; // <sub-row, first row>
+
+    for (int begin = 0; begin < n(); begin += section)
+    {
+        const int end = std::min(n(), begin + section);
+
+        /*
+         * clear sub-rows that repeat an upper one within this section
+         */
+        pattern_map.clear();
+        for (int row = begin; row < n(); row++)
+        {
+            unsigned long pattern = 0;
+            for (int col = begin; col < end; col++)
+            {
+                pattern = (pattern << 1u) | (matrix[row].test(col) ? 1u : 0u);
+            }
+            if (pattern == 0)
+            {
+                continue;
+            }
+
+            auto it = pattern_map.find(pattern);
+            if (it == pattern_map.end())
+            {
+                pattern_map.emplace(pattern, row);
+            }
+            else
+            {
+                matrix[row] ^= matrix[it->second];
+                cnot_list.emplace_back(wire(it->second), wire(row));
+            }
+        }
+
+        /*
+         * plain elimination below the diagonal of the section, where a missing
+         * pivot is swapped in from below, or added when the swap can not be tracked
+         */
+        for (int col = begin; col < end; col++)
+        {
+            bool diagonal = matrix[col].test(col);
+            for (int row = col + 1; row < n(); row++)
+            {
+                if (!matrix[row].test(col))
+                {
+                    continue;
+                }
+                if (!diagonal)
+                {
+                    if (func_map != nullptr)
+                    {
+                        std::swap(matrix[col], matrix[row]);
+                        std::swap((*func_map)[col], (*func_map)[row]);
+                        diagonal = true;
+
+                        continue;
+                    }
+                    matrix[col] ^= matrix[row];
+                    cnot_list.emplace_back(wire(row), wire(col));
+                    diagonal = true;
+                }
+                matrix[row] ^= matrix[col];
+                cnot_list.emplace_back(wire(col), wire(row));
+            }
+            if (!diagonal)
+            {
+                std::cerr << "ERROR: not full rank" << std::endl;
+
+                exit(1);
+            }
+        }
+    }
+}
+
+void PMHDecomposer::synthesize(std::vector<util::xor_func>& matrix,
+                               std::vector<int>& func_map,
+                               std::vector<cnot>& cnot_list) const
+{
+    /*
+     * make the matrix upper triangular
+     */
+    eliminate_lower(matrix, &func_map, cnot_list);
+
+    /*
+     * eliminating the transpose gives the identity, and its row operations
+     * clear the upper triangle as column operations in reverse order
+     */
+    std::vector<util::xor_func> transposed(n(), util::xor_func(n() + 1, 0));
+    for (int row = 0; row < n(); row++)
+    {
+        for (int col = row; col < n(); col++)
+        {
+            if (matrix[row].test(col))
+            {
+                transposed[col].set(row);
+            }
+        }
+    }
+    std::vector<cnot> upper_list;
+    eliminate_lower(transposed, nullptr, upper_list);
+    for (auto it = upper_list.rbegin(); it != upper_list.rend(); it++)
+    {
+        cnot_list.emplace_back(func_map[it->second], func_map[it->first]);
+    }
+
+    for (int row = 0; row < n(); row++)
+    {
+        matrix[row] = transposed[row];
+    }
+}
+
+std::list<Gate> PMHDecomposer::execute(std::vector<util::xor_func>& matrix,
+                                       std::vector<int>& func_map)
+{
+    std::list<Gate> lst;
+
+    for (int j = 0; j < n(); j++)
+    {
+        if (matrix[j].test(n()))
+        {
+            matrix[j].reset(n());
+            lst.splice(lst.begin(), util::compose_x(j, qubit_names()));
+        }
+    }
+
+    std::vector<cnot> cnot_list;
+    synthesize(matrix, func_map, cnot_list);
+    for (auto&& gate : cnot_list)
+    {
+        lst.splice(lst.begin(), util::compose_cnot(gate.first, gate.second, qubit_names()));
+    }
+
+    return lst;
+}
+
+int PMHDecomposer::count_gates(std::vector<util::xor_func>& matrix)
+{
+    int count = 0;
+
+    for (int j = 0; j < n(); j++)
+    {
+        if (matrix[j].test(n()))
+        {
+            matrix[j].reset(n());
+            count++;
+        }
+    }
+
+    std::vector<int> func_map(n());
+    for (int i = 0; i < n(); i++)
+    {
+        func_map[i] = i;
+    }
+    std::vector<cnot> cnot_list;
+    synthesize(matrix, func_map, cnot_list);
+
+    return count + static_cast<int>(cnot_list.size());
+}
+
+}
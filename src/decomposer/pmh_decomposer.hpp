@@ -0,0 +1,59 @@
+#ifndef T_SCHEDULING_PMH_DECOMPOSER_HPP
+#define T_SCHEDULING_PMH_DECOMPOSER_HPP
+
+#include <utility>
+
+#include "matrix_decomposer.hpp"
+
+#include "../layout/layout.hpp"
+
+namespace tskd {
+
+/**
+ * Patel-Markov-Hayes synthesis
+ * columns are eliminated in sections of about log(n) / 2, and duplicate
+ * sub-rows of a section are cleared with one cnot before the elimination,
+ * which gives O(n^2 / log n) cnots
+ * like GaussianDecomposer, a missing pivot is taken by a row swap that is
+ * left to func_map rather than paid for with cnots
+ */
+class PMHDecomposer final : public MatrixDecomposer
+{
+private:
+    using cnot = std::pair<int, int>; // row addition <source, destination> on wires
+
+    int section_size() const;
+
+    void synthesize(std::vector<util::xor_func>& matrix,
+                    std::vector<int>& func_map,
+                    std::vector<cnot>& cnot_list) const;
+
+    void eliminate_lower(std::vector<util::xor_func>& matrix,
+                         std::vector<int>* func_map,
+                         std::vector<cnot>& cnot_list) const;
+
+public:
+    PMHDecomposer() = default;
+
+    PMHDecomposer(const Layout& layout,
+                  const int n,
+                  const int m,
+                  const std::vector<std::string>& qubit_names)
+        : MatrixDecomposer(layout, n, m, qubit_names) { }
+
+    ~PMHDecomposer() final = default;
+
+    std::list<Gate> execute(std::vector<util::xor_func>& matrix,
+                            std::vector<int>& func_map) final;
+
+    int count_gates(std::vector<util::xor_func>& matrix) final;
+
+    int estimate_gates(std::vector<util::xor_func>& matrix) final
+    {
+        return count_gates(matrix);
+    }
+};
+
+}
+
+#endif //T_SCHEDULING_PMH_DECOMPOSER_HPP
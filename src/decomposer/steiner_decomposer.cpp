@@ -0,0 +1,379 @@
+#include <map>
+#include <queue>
+#include <memory>
+#include <algorithm>
+#include <functional>
+
+#include "steiner_decomposer.hpp"
+
+#include "../util/util.hpp"
+
+namespace tskd {
+
+void SteinerDecomposer::init()
+{
+    const Layout layout_info = layout();
+    const std::vector<std::shared_ptr<Node>> node_list = layout_info.node_list();
+
+    /*
+     * wire i is the i-th data patch of the layout
+     */
+    std::vector<int> wire_of(node_list.size(), -1); // [node id] wire
+    std::vector<std::shared_ptr<Node>> data_list;
+    for (auto&& node : node_list)
+    {
+        if (node->type() == NodeType::kdata && static_cast<int>(data_list.size()) < n())
+        {
+            wire_of[node->id()] = static_cast<int>(data_list.size());
+            data_list.push_back(node);
+        }
+    }
+
+    std::vector<std::vector<int>> node_adjacent(node_list.size());
+    for (auto&& edge : layout_info.edge_list())
+    {
+        node_adjacent[edge->node_a()->id()].push_back(edge->node_b()->id());
+        node_adjacent[edge->node_b()->id()].push_back(edge->node_a()->id());
+    }
+
+    /*
+     * two data qubits are adjacent when an edge or a single ancilla patch joins them
+     */
+    std::vector<std::vector<bool>> adjacent(n(), std::vector<bool>(n(), false));
+    for (size_t wire = 0; wire < data_list.size(); wire++)
+    {
+        for (auto&& next : node_adjacent[data_list[wire]->id()])
+        {
+            if (wire_of[next] != -1)
+            {
+                adjacent[wire][wire_of[next]] = true;
+
+                continue;
+            }
+            for (auto&& other : node_adjacent[next])
+            {
+                if (wire_of[other] != -1 && wire_of[other] != static_cast<int>(wire))
+                {
+                    adjacent[wire][wire_of[other]] = true;
+                }
+            }
+        }
+    }
+
+    /*
+     * snake through the rows of data patches; the last row is the one that may
+     * be partial and starts at the left, so the rows alternate towards it
+     */
+    std::map<int, std::vector<std::pair<int, int>>> row_map; // <y, [<x, wire>]>
+    for (size_t wire = 0; wire < data_list.size(); wire++)
+    {
+        row_map[data_list[wire]->y()].emplace_back(data_list[wire]->x(), static_cast<int>(wire));
+    }
+    order_.clear();
+    int row_index = 0;
+    for (auto&& row : row_map)
+    {
+        std::vector<std::pair<int, int>>& patch_list = row.second;
+        std::sort(patch_list.begin(), patch_list.end());
+        if ((static_cast<int>(row_map.size()) - 1 - row_index) % 2 == 1)
+        {
+            std::reverse(patch_list.begin(), patch_list.end());
+        }
+        for (auto&& patch : patch_list)
+        {
+            order_.push_back(patch.second);
+        }
+        row_index++;
+    }
+
+    bool is_path = static_cast<int>(order_.size()) == n();
+    for (int k = 1; is_path && k < n(); k++)
+    {
+        is_path = adjacent[order_[k - 1]][order_[k]];
+    }
+    if (!is_path)
+    {
+        // no hamiltonian path found, treat every pair as adjacent
+        order_.resize(n());
+        for (int k = 0; k < n(); k++)
+        {
+            order_[k] = k;
+            std::fill(adjacent[k].begin(), adjacent[k].end(), true);
+        }
+    }
+
+    neighbor_.assign(n(), std::vector<int>());
+    for (int k = 0; k < n(); k++)
+    {
+        for (int l = 0; l < n(); l++)
+        {
+            if (k != l && adjacent[order_[k]][order_[l]])
+            {
+                neighbor_[k].push_back(l);
+            }
+        }
+    }
+}
+
+void SteinerDecomposer::match_columns(const std::vector<util::xor_func>& matrix,
+                                      std::vector<int>& column) const
+{
+    /*
+     * give every wire a column holding a one, its own column when possible,
+     * so that permutations cost nothing
+     */
+    std::vector<int> owner(n(), -1); // [column] wire
+    std::vector<bool> visited(n(), false);
+    column.assign(n(), -1);
+
+    std::function<bool(int)> augment = [&](int wire)
+    {
+        for (int k = -1; k < n(); k++)
+        {
+            const int col = (k < 0) ? wire : k;
+            if (!matrix[wire].test(col) || visited[col])
+            {
+                continue;
+            }
+            visited[col] = true;
+            if (owner[col] == -1 || augment(owner[col]))
+            {
+                owner[col] = wire;
+                column[wire] = col;
+
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    for (int wire = 0; wire < n(); wire++)
+    {
+        std::fill(visited.begin(), visited.end(), false);
+        if (!augment(wire))
+        {
+            std::cerr << "ERROR: not full rank" << std::endl;
+
+            exit(1);
+        }
+    }
+}
+
+void SteinerDecomposer::build_tree(int root,
+                                   const std::vector<bool>& terminal,
+                                   bool upper,
+                                   std::vector<int>& parent,
+                                   std::vector<int>& tree) const
+{
+    /*
+     * shortest paths from the root, over positions after it (lower) or
+     * decreasing away from it (upper)
+     */
+    std::vector<int> bfs_order;
+    std::fill(parent.begin(), parent.end(), -1);
+    parent[root] = root;
+    std::queue<int> que;
+    que.push(root);
+    while (!que.empty())
+    {
+        const int u = que.front();
+        que.pop();
+        bfs_order.push_back(u);
+        for (auto&& v : neighbor_[u])
+        {
+            if (parent[v] != -1 || (upper ? v > u : v < root))
+            {
+                continue;
+            }
+            parent[v] = u;
+            que.push(v);
+        }
+    }
+
+    // keep the paths that lead to a terminal
+    std::vector<bool> in_tree(n(), false);
+    for (int t = 0; t < n(); t++)
+    {
+        for (int v = t; terminal[t] && v != root && !in_tree[v]; v = parent[v])
+        {
+            in_tree[v] = true;
+        }
+    }
+
+    tree.clear();
+    for (auto&& v : bfs_order)
+    {
+        if (in_tree[v])
+        {
+            tree.push_back(v);
+        }
+    }
+}
+
+void SteinerDecomposer::synthesize(std::vector<util::xor_func>& matrix,
+                                   std::vector<int>& column,
+                                   std::vector<cnot>& cnot_list) const
+{
+    /*
+     * eliminate matrix Q instead, where Q permutes the columns onto the wires
+     * holding a one there, and rows and columns follow the hamiltonian path
+     */
+    match_columns(matrix, column);
+    std::vector<util::xor_func> a(n(), util::xor_func(n(), 0));
+    for (int k = 0; k < n(); k++)
+    {
+        for (int l = 0; l < n(); l++)
+        {
+            if (matrix[order_[k]].test(column[order_[l]]))
+            {
+                a[k].set(l);
+            }
+        }
+    }
+
+    std::vector<bool> terminal(n(), false);
+    std::vector<int> parent(n(), -1);
+    std::vector<int> tree;
+
+    /*
+     * lower triangle: fill the tree from the leaves, then clear it from the leaves
+     */
+    for (int c = 0; c < n(); c++)
+    {
+        bool any = false;
+        for (int r = 0; r < n(); r++)
+        {
+            terminal[r] = r > c && a[r].test(c);
+            any |= terminal[r];
+        }
+        if (any)
+        {
+            build_tree(c, terminal, false, parent, tree);
+            for (auto it = tree.rbegin(); it != tree.rend(); it++)
+            {
+                const int p = parent[*it];
+                if (!a[p].test(c) && a[*it].test(c))
+                {
+                    a[p] ^= a[*it];
+                    cnot_list.emplace_back(*it, p);
+                }
+            }
+            for (auto it = tree.rbegin(); it != tree.rend(); it++)
+            {
+                a[*it] ^= a[parent[*it]];
+                cnot_list.emplace_back(parent[*it], *it);
+            }
+        }
+        if (!a[c].test(c))
+        {
+            std::cerr << "ERROR: not full rank" << std::endl;
+
+            exit(1);
+        }
+    }
+
+    /*
+     * upper triangle: the pivot row is a unit vector by now, fill the tree from
+     * the root and clear it from the leaves, always adding a later row
+     */
+    for (int c = n() - 1; c > 0; c--)
+    {
+        bool any = false;
+        for (int r = 0; r < n(); r++)
+        {
+            terminal[r] = r < c && a[r].test(c);
+            any |= terminal[r];
+        }
+        if (!any)
+        {
+            continue;
+        }
+        build_tree(c, terminal, true, parent, tree);
+        for (auto&& v : tree)
+        {
+            if (!a[v].test(c))
+            {
+                a[v] ^= a[parent[v]];
+                cnot_list.emplace_back(parent[v], v);
+            }
+        }
+        for (auto it = tree.rbegin(); it != tree.rend(); it++)
+        {
+            a[*it] ^= a[parent[*it]];
+            cnot_list.emplace_back(parent[*it], *it);
+        }
+    }
+}
+
+std::list<Gate> SteinerDecomposer::execute(std::vector<util::xor_func>& matrix,
+                                           std::vector<int>& func_map)
+{
+    std::list<Gate> lst;
+
+    for (int j = 0; j < n(); j++)
+    {
+        if (matrix[j].test(n()))
+        {
+            matrix[j].reset(n());
+            lst.splice(lst.begin(), util::compose_x(j, qubit_names()));
+        }
+    }
+
+    std::vector<int> column;
+    std::vector<cnot> cnot_list;
+    synthesize(matrix, column, cnot_list);
+
+    /*
+     * neighbouring cnots on disjoint qubits use disjoint ancilla patches,
+     * so emit them layer by layer (as soon as both qubits are free)
+     */
+    std::vector<int> ready(n(), 0);
+    std::vector<std::pair<int, size_t>> layer_list; // <layer, index of cnot>
+    for (size_t i = 0; i < cnot_list.size(); i++)
+    {
+        const int layer = std::max(ready[cnot_list[i].first], ready[cnot_list[i].second]);
+        ready[cnot_list[i].first] = layer + 1;
+        ready[cnot_list[i].second] = layer + 1;
+        layer_list.emplace_back(layer, i);
+    }
+    std::sort(layer_list.begin(), layer_list.end());
+
+    for (auto&& entry : layer_list)
+    {
+        const cnot& gate = cnot_list[entry.second];
+        lst.splice(lst.begin(), util::compose_cnot(func_map[order_[gate.first]], func_map[order_[gate.second]],
+                                                   qubit_names()));
+    }
+
+    // wire j ends with the function of its matched column
+    const std::vector<int> wire_map(func_map);
+    for (int j = 0; j < n(); j++)
+    {
+        func_map[column[j]] = wire_map[j];
+    }
+
+    return lst;
+}
+
+int SteinerDecomposer::count_gates(std::vector<util::xor_func>& matrix)
+{
+    int count = 0;
+
+    for (int j = 0; j < n(); j++)
+    {
+        if (matrix[j].test(n()))
+        {
+            matrix[j].reset(n());
+            count++;
+        }
+    }
+
+    std::vector<int> column;
+    std::vector<cnot> cnot_list;
+    synthesize(matrix, column, cnot_list);
+
+    return count + static_cast<int>(cnot_list.size());
+}
+
+}
@@ -0,0 +1,72 @@
+#ifndef T_SCHEDULING_STEINER_DECOMPOSER_HPP
+#define T_SCHEDULING_STEINER_DECOMPOSER_HPP
+
+#include <utility>
+
+#include "matrix_decomposer.hpp"
+
+#include "../layout/layout.hpp"
+
+namespace tskd {
+
+/**
+ * architecture-aware synthesis by Steiner-tree elimination
+ * every cnot acts on data qubits that are neighbours on the layout grid,
+ * i.e. joined through a single ancilla patch, so no routing is needed
+ * columns are eliminated along a hamiltonian path of the data qubits;
+ * below the diagonal a pivot reaches its rows through a tree over the
+ * uneliminated qubits, above it through a tree whose indices decrease away
+ * from the pivot, which keeps the triangle below intact
+ * the cnots are emitted in layers of disjoint qubits
+ */
+class SteinerDecomposer final : public MatrixDecomposer
+{
+private:
+    using cnot = std::pair<int, int>; // row addition <source, destination> on positions
+
+    std::vector<int> order_;                  // [position] wire, along the hamiltonian path
+    std::vector<std::vector<int>> neighbor_;  // [position] adjacent positions
+
+    void init();
+
+    void match_columns(const std::vector<util::xor_func>& matrix,
+                       std::vector<int>& column) const;
+
+    void build_tree(int root,
+                    const std::vector<bool>& terminal,
+                    bool upper,
+                    std::vector<int>& parent,
+                    std::vector<int>& tree) const;
+
+    void synthesize(std::vector<util::xor_func>& matrix,
+                    std::vector<int>& column,
+                    std::vector<cnot>& cnot_list) const;
+
+public:
+    SteinerDecomposer() = default;
+
+    SteinerDecomposer(const Layout& layout,
+                      const int n,
+                      const int m,
+                      const std::vector<std::string>& qubit_names)
+        : MatrixDecomposer(layout, n, m, qubit_names)
+    {
+        init();
+    }
+
+    ~SteinerDecomposer() final = default;
+
+    std::list<Gate> execute(std::vector<util::xor_func>& matrix,
+                            std::vector<int>& func_map) final;
+
+    int count_gates(std::vector<util::xor_func>& matrix) final;
+
+    int estimate_gates(std::vector<util::xor_func>& matrix) final
+    {
+        return count_gates(matrix);
+    }
+};
+
+}
+
+#endif //T_SCHEDULING_STEINER_DECOMPOSER_HPP
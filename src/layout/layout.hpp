@@ -79,6 +79,11 @@ public:
         return y_;
     }
 
+    NodeType type() const
+    {
+        return type_;
+    }
+
     std::vector<std::shared_ptr<Edge>> edge_list() const
     {
         return edge_list_;
@@ -240,6 +245,11 @@ public:
         init();
     }
 
+    const util::Option& option() const
+    {
+        return option_;
+    }
+
     LayoutType type() const
     {
         return type_;
@@ -49,6 +49,14 @@ int main(int argc, char** argv)
     {
         option.set_dec_type(DecompositionType::kparallel);
     }
+    else if (dec_type == "pmh")
+    {
+        option.set_dec_type(DecompositionType::kpmh);
+    }
+    else if (dec_type == "steiner")
+    {
+        option.set_dec_type(DecompositionType::ksteiner);
+    }
     else
     {
         option.set_dec_type(DecompositionType::kgauss);
@@ -75,6 +83,113 @@ int main(int argc, char** argv)
     const int num_row = std::stoi(nbr);
     option.set_num_buffer_row(num_row);
 
+    /*
+     * optional arguments given as name=value
+     */
+    for (int i = 7; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        const size_t pos = arg.find('=');
+        const std::string name = arg.substr(0, pos);
+        const std::string value = (pos == std::string::npos) ? "" : arg.substr(pos + 1);
+        if (name == "bulk")
+        {
+            option.set_bulk_partition(value == "true");
+        }
+        else if (name == "thread")
+        {
+            option.set_num_thread(std::stoi(value));
+        }
+        else if (name == "sa_chain")
+        {
+            option.set_num_sa_chain(std::stoi(value));
+        }
+        else if (name == "sa_time")
+        {
+            option.set_sa_time(std::stol(value));
+        }
+        else if (name == "sa_iter")
+        {
+            option.set_sa_iteration(std::stol(value));
+        }
+        else if (name == "sa_patience")
+        {
+            option.set_sa_patience(std::stol(value));
+        }
+        else if (name == "sa_seed")
+        {
+            option.set_sa_seed(std::stol(value));
+        }
+        else if (name == "sa_cache")
+        {
+            option.set_sa_cache(value == "true");
+        }
+        else if (name == "sa_cost")
+        {
+            if (value == "count")
+            {
+                option.set_sa_cost(ReorderCost::kcount);
+            }
+            else if (value == "layer")
+            {
+                option.set_sa_cost(ReorderCost::klayer);
+            }
+            else
+            {
+                std::cerr << "invalid sa cost: " << value << std::endl;
+
+                exit(1);
+            }
+        }
+        else if (name == "oracle")
+        {
+            if (value == "int")
+            {
+                option.set_oracle_encoding(OracleEncoding::kinteger);
+            }
+            else if (value == "bool")
+            {
+                option.set_oracle_encoding(OracleEncoding::kboolean);
+            }
+            else
+            {
+                std::cerr << "invalid oracle encoding: " << value << std::endl;
+
+                exit(1);
+            }
+        }
+        else if (name == "oracle_backend")
+        {
+            if (value == "sat")
+            {
+                option.set_oracle_backend(OracleBackendType::ksat);
+            }
+            else if (value == "z3")
+            {
+#ifdef TSKD_WITH_Z3
+                option.set_oracle_backend(OracleBackendType::kz3);
+#else
+                std::cerr << "oracle backend z3 is not built in" << std::endl;
+
+                exit(1);
+#endif
+            }
+            else
+            {
+                std::cerr << "invalid oracle backend: " << value << std::endl;
+
+                exit(1);
+            }
+        }
+        else
+        {
+            std::cerr << "invalid option: " << arg << std::endl;
+
+            exit(1);
+        }
+    }
+
+    option.init_sa_budget();
 
     option.set_input_path(path);
     option.set_distillation_step(10);
@@ -1,66 +1,340 @@
+#include <algorithm>
+#include <cstdint>
+
 #include "matrix_reconstructor.hpp"
 
 namespace tskd {
 
-static int evaluate_matrix(const int n,
-                           std::vector<util::xor_func> matrix)
+/**
+ * Gauss-Jordan cost of a matrix that changes by column swaps
+ * rows are packed into flat 64-bit words, and the forward elimination is
+ * checkpointed before every pivot column, so swapping columns a < b only
+ * re-runs it from column a
+ * with a placement, the cnots are also list-scheduled into layers (a pivot
+ * fans out to all its targets at once, as in ParallelDecomposer) and the
+ * cost becomes the layer count, ties broken by the cnot count
+ */
+class SwapEvaluator
 {
-    constexpr int cnot_cost = 1;
+private:
+    using word = uint64_t;
+
+    static constexpr int word_bits = 64;
+
+    int n_;
+    int width_; // words per row
+    int size_;  // words per matrix
+
+    std::vector<word> state_; // [i] matrix before pivot column i, [n] triangular
+    std::vector<int> count_;  // [i] cnots counted before pivot column i
+    std::vector<int> layer_;  // [i] wire of each row, ready layer of each wire and routed cells before pivot column i
+    std::vector<word> trial_; // same for the evaluated swap
+    std::vector<int> trial_count_;
+    std::vector<int> trial_layer_;
+    std::vector<word> scratch_;
+    std::vector<int> scratch_layer_;
+
+    const Placement* placement_; // null: cnot count only
+    int layer_size_;             // ints per layer checkpoint
+
+    int lo_;
+    int col_a_;
+    int col_b_;
+    long eval_;
+    long trial_eval_;
+
+    inline word* matrix(std::vector<word>& state,
+                        int i)
+    {
+        return state.data() + static_cast<size_t>(i) * size_;
+    }
+
+    inline int* layer(std::vector<int>& layer,
+                      int i)
+    {
+        return layer.data() + static_cast<size_t>(i) * layer_size_;
+    }
+
+    inline bool test(const word* mat,
+                     int row,
+                     int col) const
+    {
+        return (mat[row * width_ + col / word_bits] >> (col % word_bits)) & 1u;
+    }
 
-    int result = 0;
+    inline void xor_row(word* mat,
+                        int dst,
+                        int src) const
+    {
+        for (int k = 0; k < width_; k++)
+        {
+            mat[dst * width_ + k] ^= mat[src * width_ + k];
+        }
+    }
 
-    bool flg = false;
-    // Make triangular
-    for (int i = 0; i < n; i++)
+    void swap_column(word* mat,
+                     int a,
+                     int b) const
     {
-        flg = false;
-        for (int j = i; j < n; j++)
+        const word mask_a = word(1) << (a % word_bits);
+        const word mask_b = word(1) << (b % word_bits);
+        for (int row = 0; row < n_; row++)
         {
-            if (matrix[j].test(i))
+            word& wa = mat[row * width_ + a / word_bits];
+            word& wb = mat[row * width_ + b / word_bits];
+            const bool bit_a = (wa & mask_a) != 0;
+            const bool bit_b = (wb & mask_b) != 0;
+            if (bit_a != bit_b)
             {
-                if (!flg)
+                wa ^= mask_a;
+                wb ^= mask_b;
+            }
+        }
+    }
+
+    /**
+     * schedule a cnot of the fan-out of control
+     * @param lay layer checkpoint
+     * @param control_ready ready layer of the control when its fan-out began
+     * @param control control wire
+     * @param target target wire
+     * @return layer of the cnot
+     */
+    inline int schedule(int* lay,
+                        int control_ready,
+                        int control,
+                        int target) const
+    {
+        int* ready = lay + n_;
+        const int l = std::max(control_ready, ready[target]) + 1;
+        ready[target] = l;
+        lay[2 * n_] += std::abs(placement_->x[control] - placement_->x[target])
+                       + std::abs(placement_->y[control] - placement_->y[target]) - 1;
+
+        return l;
+    }
+
+    /**
+     * run the forward elimination from column begin, filling state[begin + 1..n]
+     */
+    void forward(std::vector<word>& state,
+                 std::vector<int>& count,
+                 std::vector<int>& lay,
+                 int begin)
+    {
+        for (int i = begin; i < n_; i++)
+        {
+            std::copy(matrix(state, i), matrix(state, i) + size_, matrix(state, i + 1));
+            count[i + 1] = count[i];
+            word* mat = matrix(state, i + 1);
+            int* wire = nullptr;
+            if (placement_ != nullptr)
+            {
+                std::copy(layer(lay, i), layer(lay, i) + layer_size_, layer(lay, i + 1));
+                wire = layer(lay, i + 1);
+            }
+            bool flg = false;
+            int control_ready = 0;
+            int fan_out = 0;
+            for (int j = i; j < n_; j++)
+            {
+                if (test(mat, j, i))
                 {
-                    if (j != i)
+                    if (!flg)
                     {
-                        swap(matrix[i], matrix[j]);
+                        if (j != i)
+                        {
+                            std::swap_ranges(mat + i * width_, mat + (i + 1) * width_, mat + j * width_);
+                            if (wire != nullptr)
+                            {
+                                std::swap(wire[i], wire[j]);
+                            }
+                        }
+                        if (wire != nullptr)
+                        {
+                            control_ready = wire[n_ + wire[i]];
+                            fan_out = control_ready;
+                        }
+                        flg = true;
+                    }
+                    else
+                    {
+                        xor_row(mat, j, i);
+                        count[i + 1]++;
+                        if (wire != nullptr)
+                        {
+                            fan_out = std::max(fan_out, schedule(wire, control_ready, wire[i], wire[j]));
+                        }
                     }
-                    flg = true;
                 }
-                else
+            }
+            if (!flg)
+            {
+                std::cerr << "ERROR: not full rank" << std::endl;
+
+                exit(1);
+            }
+            if (wire != nullptr)
+            {
+                wire[n_ + wire[i]] = fan_out;
+            }
+        }
+    }
+
+    /**
+     * finish the back substitution of a triangular matrix and score it
+     */
+    long backward(const word* triangular,
+                  int count,
+                  const int* lay)
+    {
+        std::copy(triangular, triangular + size_, scratch_.begin());
+        word* mat = scratch_.data();
+        int* wire = nullptr;
+        if (placement_ != nullptr)
+        {
+            std::copy(lay, lay + layer_size_, scratch_layer_.begin());
+            wire = scratch_layer_.data();
+        }
+        int result = count;
+        for (int i = n_ - 1; i > 0; i--)
+        {
+            const int control_ready = (wire != nullptr) ? wire[n_ + wire[i]] : 0;
+            int fan_out = control_ready;
+            for (int j = i - 1; j >= 0; j--)
+            {
+                if (test(mat, j, i))
                 {
-                    matrix[j] ^= matrix[i];
-                    result += cnot_cost;
+                    xor_row(mat, j, i);
+                    result++;
+                    if (wire != nullptr)
+                    {
+                        fan_out = std::max(fan_out, schedule(wire, control_ready, wire[i], wire[j]));
+                    }
                 }
             }
+            if (wire != nullptr)
+            {
+                wire[n_ + wire[i]] = fan_out;
+            }
         }
-        if (!flg)
-        {
-            std::cerr << "ERROR: not full rank" << std::endl;
 
-            exit(1);
+        if (wire == nullptr)
+        {
+            return result;
         }
+
+        /*
+         * the routes of one layer share the ancilla patches, so the layers
+         * are at least the critical path and the routed cells over the ancillas
+         */
+        const int critical = *std::max_element(wire + n_, wire + 2 * n_);
+        const int cells = wire[2 * n_];
+        const int area = (cells + placement_->num_ancilla - 1) / placement_->num_ancilla;
+        const long depth = std::max(critical, area);
+
+        // cnot count of Gauss-Jordan is below n^2
+        return depth * n_ * n_ + result;
     }
 
-    // Finish the job
-    for (int i = n - 1; i > 0; i--)
+public:
+    SwapEvaluator(int n,
+                  const std::vector<util::xor_func>& mat,
+                  const Placement* placement)
+            : n_(n),
+              width_((n + word_bits - 1) / word_bits),
+              size_(n * ((n + word_bits - 1) / word_bits)),
+              state_(static_cast<size_t>(n + 1) * size_, 0),
+              count_(n + 1, 0),
+              trial_(state_.size(), 0),
+              trial_count_(n + 1, 0),
+              scratch_(size_, 0),
+              placement_(placement),
+              layer_size_(placement != nullptr ? 2 * n + 1 : 0),
+              lo_(0),
+              col_a_(0),
+              col_b_(0)
     {
-        for (int j = i - 1; j >= 0; j--)
+        // only the first n columns take part in the elimination
+        word* first = matrix(state_, 0);
+        for (int row = 0; row < n_; row++)
         {
-            if (matrix[j].test(i))
+            for (int col = 0; col < n_; col++)
             {
-                matrix[j] ^= matrix[i];
-                result += cnot_cost;
+                if (mat[row].test(col))
+                {
+                    first[row * width_ + col / word_bits] |= word(1) << (col % word_bits);
+                }
+            }
+        }
+        layer_.assign(static_cast<size_t>(n + 1) * layer_size_, 0);
+        trial_layer_.assign(layer_.size(), 0);
+        scratch_layer_.assign(layer_size_, 0);
+        if (placement_ != nullptr)
+        {
+            // row i is wire i before elimination
+            for (int row = 0; row < n_; row++)
+            {
+                layer_[row] = row;
             }
         }
+        forward(state_, count_, layer_, 0);
+        eval_ = backward(matrix(state_, n_), count_[n_], layer(layer_, n_));
+        trial_eval_ = eval_;
     }
 
-    return result;
-}
+    long eval() const
+    {
+        return eval_;
+    }
+
+    /**
+     * evaluate the matrix with columns a and b swapped, without committing it
+     * @return cost
+     */
+    long evaluate_swap(int a,
+                       int b)
+    {
+        lo_ = std::min(a, b);
+        col_a_ = a;
+        col_b_ = b;
+        std::copy(matrix(state_, lo_), matrix(state_, lo_) + size_, matrix(trial_, lo_));
+        trial_count_[lo_] = count_[lo_];
+        std::copy(layer(layer_, lo_), layer(layer_, lo_) + layer_size_, layer(trial_layer_, lo_));
+        swap_column(matrix(trial_, lo_), a, b);
+        forward(trial_, trial_count_, trial_layer_, lo_);
+        trial_eval_ = backward(matrix(trial_, n_), trial_count_[n_], layer(trial_layer_, n_));
+
+        return trial_eval_;
+    }
+
+    /**
+     * commit the last evaluated swap
+     */
+    void accept()
+    {
+        for (int i = 0; i < lo_; i++)
+        {
+            swap_column(matrix(state_, i), col_a_, col_b_);
+        }
+        std::copy(matrix(trial_, lo_), trial_.data() + trial_.size(), matrix(state_, lo_));
+        std::copy(trial_count_.begin() + lo_, trial_count_.end(), count_.begin() + lo_);
+        std::copy(layer(trial_layer_, lo_), trial_layer_.data() + trial_layer_.size(), layer(layer_, lo_));
+        eval_ = trial_eval_;
+    }
+};
 
 void MatrixReconstructor::init()
 {
     // initialize some variables
-    engine_ = std::mt19937(seed_generator_());
+    if (budget_ != nullptr && budget_->seed() >= 0)
+    {
+        engine_ = std::mt19937(static_cast<std::mt19937::result_type>(budget_->seed()));
+    }
+    else
+    {
+        engine_ = std::mt19937(seed_generator_());
+    }
     rate_ = 10000;
     req_time_ = std::chrono::milliseconds(200);
 
@@ -75,110 +349,209 @@ void MatrixReconstructor::init()
     }
 }
 
-std::vector<util::xor_func> MatrixReconstructor::execute(const std::vector<util::xor_func>& preparation,
-                                                         const std::vector<util::xor_func>& restoration,
-                                                         std::unordered_map<int, int>& target_phase_map)
+void MatrixReconstructor::anneal(const std::vector<util::xor_func>& preparation,
+                                 const std::vector<util::xor_func>& start_prep,
+                                 const Schedule& schedule,
+                                 Chain& chain) const
 {
     // random generator
     const int matrix_size = static_cast<int>(preparation.size());
     std::uniform_int_distribution<> dist_index(0, matrix_size - 1);
 
-    // SA parameters
+    // SA parameters, the temperature follows the elapsed time or the move count
+    const bool by_iteration = schedule.num_iteration > 0;
+    const long horizon = by_iteration ? schedule.num_iteration : schedule.time.count();
     const auto start = std::chrono::system_clock::now();
-    const auto end = std::chrono::system_clock::now() + req_time_;
-    auto current_time = start;
+    const auto end = start + schedule.time;
+    long progress = 0;
+    long num_move = 0;
+    long num_stall = 0;
     std::uniform_int_distribution<> dist(1, rate_);
     constexpr int loop_count = 100;
 
-    // initial parameters
-    std::vector<util::xor_func> init_prep(identity_);
-    util::compose(num_qubit_, init_prep, restoration);
-
     // current (temporary) parameters
-    std::vector<util::xor_func> current_prep(init_prep);
+    std::vector<util::xor_func> current_prep(start_prep);
+    std::vector<util::xor_func> tmp_rest(identity_);
     std::vector<util::xor_func> tmp_prep(preparation);
-    util::compose(num_qubit_, tmp_prep, restoration);
     std::vector<util::xor_func> rev_prep(identity_);
+    util::compose(num_qubit_, tmp_rest, current_prep);
+    util::compose(num_qubit_, tmp_prep, tmp_rest);
     util::compose(num_qubit_, rev_prep, tmp_prep);
-    int current_eval = evaluate_matrix(num_qubit_, rev_prep);
+
+    /*
+     * swapping rows a, b of current_prep swaps columns a, b of rev_prep,
+     * so moves are evaluated on rev_prep directly
+     */
+    SwapEvaluator evaluator(num_qubit_, rev_prep, placement_.get());
+    long current_eval = evaluator.eval();
 
     // best parameters
-    int best_eval = current_eval;
-    std::vector<util::xor_func> best_prep = current_prep;
+    chain.best_eval = current_eval;
+    chain.best_prep = current_prep;
 
     /*
      * implement SA
      */
     while (true)
     {
-        current_time = std::chrono::system_clock::now();
-        if (current_time > end)
+        if (by_iteration)
+        {
+            if (num_move >= horizon)
+            {
+                break;
+            }
+        }
+        else
+        {
+            const auto current_time = std::chrono::system_clock::now();
+            if (current_time > end)
+            {
+                break;
+            }
+            progress = std::chrono::duration_cast<std::chrono::milliseconds>(current_time - start).count();
+        }
+
+        // converged
+        if (schedule.patience > 0 && num_stall >= schedule.patience)
         {
             break;
         }
 
-        for (int loop = 0; loop < loop_count; ++loop)
+        for (int loop = 0; loop < loop_count && !(by_iteration && num_move >= horizon); ++loop)
         {
+            num_move++;
+            num_stall++;
+            if (by_iteration)
+            {
+                progress = num_move;
+            }
+
             // choice index randomly
-            const int target_a = dist_index(engine_);
-            const int target_b = dist_index(engine_);
+            const int target_a = dist_index(chain.engine);
+            const int target_b = dist_index(chain.engine);
 
             if (target_a == target_b)
             {
                 continue;
             }
 
-            // swap process
-            std::swap(current_prep[target_a], current_prep[target_b]);
-
             // evaluate matrix
-            std::vector<util::xor_func> tmp_rest(identity_);
-            std::vector<util::xor_func> tmp_rev_prep(identity_);
-            tmp_prep = preparation;
-            util::compose(num_qubit_, tmp_rest, current_prep);
-            util::compose(num_qubit_, tmp_prep, tmp_rest);
-            util::compose(num_qubit_, tmp_rev_prep, tmp_prep);
-            const int next_eval = evaluate_matrix(num_qubit_, tmp_rev_prep);
+            const long next_eval = evaluator.evaluate_swap(target_a, target_b);
 
             // sa update param
-            const auto time = std::chrono::duration_cast<std::chrono::milliseconds>(current_time - start);
-            const bool force_next = (rate_ * (req_time_.count() - time.count())) > (req_time_.count() * dist(seed_generator_));
+            const bool force_next = (rate_ * (horizon - progress)) > (horizon * dist(chain.engine));
 
             // update
             if (current_eval > next_eval || force_next)
             {
                 current_eval = next_eval;
-            }
-            else
-            {
+                evaluator.accept();
                 std::swap(current_prep[target_a], current_prep[target_b]);
             }
 
-            if (best_eval > current_eval)
+            if (chain.best_eval > current_eval)
             {
-                best_eval = current_eval;
-                best_prep = current_prep;
+                chain.best_eval = current_eval;
+                chain.best_prep = current_prep;
+                num_stall = 0;
             }
         }
     }
+}
+
+std::vector<util::xor_func> MatrixReconstructor::search(const std::vector<util::xor_func>& preparation,
+                                                        const std::vector<util::xor_func>& start_prep)
+{
+    /*
+     * take this call's share of the run budget
+     */
+    const auto start = std::chrono::system_clock::now();
+    Schedule schedule{req_time_, 0, 0};
+    if (budget_ != nullptr)
+    {
+        schedule.num_iteration = budget_->num_iteration();
+        schedule.patience = budget_->patience();
+        if (schedule.num_iteration == 0)
+        {
+            schedule.time = budget_->request(num_qubit_, req_time_);
+        }
+    }
+
+    /*
+     * run independent chains within the same budget, seeded from the shared engine
+     */
+    std::vector<Chain> chains(std::max(1, num_chain_));
+    for (auto&& chain : chains)
+    {
+        chain.engine = std::mt19937(engine_());
+    }
+
+    if (chains.size() > 1)
+    {
+        if (pool_ == nullptr)
+        {
+            pool_ = std::make_shared<util::ThreadPool>(static_cast<int>(chains.size()));
+        }
+        pool_->run(static_cast<int>(chains.size()), [&](int k) {
+            anneal(preparation, start_prep, schedule, chains[k]);
+        });
+    }
+    else
+    {
+        anneal(preparation, start_prep, schedule, chains.front());
+    }
+
+    // global best, the first chain wins ties
+    const Chain* best = &chains.front();
+    for (auto&& chain : chains)
+    {
+        if (chain.best_eval < best->best_eval)
+        {
+            best = &chain;
+        }
+    }
+
+    if (budget_ != nullptr)
+    {
+        budget_->release(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - start));
+    }
+
+    return best->best_prep;
+}
+
+std::vector<util::xor_func> MatrixReconstructor::execute(const std::vector<util::xor_func>& preparation,
+                                                         const std::vector<util::xor_func>& restoration,
+                                                         std::unordered_map<int, int>& target_phase_map)
+{
+    // initial parameters
+    std::vector<util::xor_func> init_prep(identity_);
+    util::compose(num_qubit_, init_prep, restoration);
+
+    std::vector<util::xor_func> best_prep;
+    if (cache_ == nullptr || !cache_->find(preparation, init_prep, best_prep))
+    {
+        best_prep = search(preparation, cache_ != nullptr ? cache_->warm_start(preparation, init_prep) : init_prep);
+        if (cache_ != nullptr)
+        {
+            cache_->store(preparation, init_prep, best_prep);
+        }
+    }
 
     // set result restoration
     std::vector<util::xor_func> result_rest(identity_);
     util::compose(num_qubit_, result_rest, best_prep);
 
     // update target phase
+    std::vector<int> row_map(init_prep.size(), -1);
+    util::match_parities(init_prep, best_prep, row_map);
     std::unordered_map<int, int> result_target_phase_map;
     for (auto&& map : target_phase_map)
     {
         const int bit = map.first;
         const int phase_index = map.second;
-        const util::xor_func func = init_prep[bit];
-        for (size_t i = 0; i < best_prep.size(); i++)
+        if (row_map[bit] != -1)
         {
-            if (func == best_prep[i])
-            {
-                result_target_phase_map.emplace(i, phase_index);
-            }
+            result_target_phase_map.emplace(row_map[bit], phase_index);
         }
     }
     target_phase_map = result_target_phase_map;
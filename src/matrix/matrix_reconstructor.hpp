@@ -2,20 +2,81 @@
 #define T_SCHEDULING_MATRIX_RECONSTRUCTOR_HPP
 
 #include <random>
+#include <algorithm>
 #include <chrono>
+#include <memory>
 #include <unordered_map>
 
 #include "../util/util.hpp"
+#include "../util/thread_pool.hpp"
+#include "../util/sa_budget.hpp"
+#include "../util/option.hpp"
+
+#include "../layout/layout.hpp"
+
+#include "reorder_cache.hpp"
 
 namespace tskd {
 
+/**
+ * grid position of each data qubit, for the layered cost of row reordering
+ */
+struct Placement
+{
+    std::vector<int> x; // [wire]
+    std::vector<int> y; // [wire]
+    int num_ancilla;
+
+    Placement() = default;
+
+    explicit Placement(const Layout& layout)
+            : num_ancilla(0)
+    {
+        for (auto&& node : layout.node_list())
+        {
+            if (node->type() == NodeType::kdata)
+            {
+                x.push_back(node->x());
+                y.push_back(node->y());
+            }
+            else
+            {
+                num_ancilla++;
+            }
+        }
+        num_ancilla = std::max(1, num_ancilla);
+    }
+};
+
 class MatrixReconstructor
 {
 private:
+    /**
+     * state of one annealing chain
+     */
+    struct Chain
+    {
+        std::mt19937 engine;
+
+        long best_eval;
+        std::vector<util::xor_func> best_prep;
+    };
+
+    /**
+     * stopping rule of one call
+     */
+    struct Schedule
+    {
+        std::chrono::milliseconds time; // used when num_iteration is 0
+        long num_iteration;
+        long patience;
+    };
+
     std::vector<util::xor_func> input_;
 
     int dimension_;
     int num_qubit_;
+    int num_chain_;
 
     // SA parameters
     std::random_device seed_generator_;
@@ -26,15 +87,38 @@ private:
 
     std::vector<util::xor_func> identity_;
 
+    std::shared_ptr<util::ThreadPool> pool_; // runs the chains, created on first use when num_chain_ > 1
+
+    std::shared_ptr<util::SABudget> budget_; // null: 200 ms per call with a random seed
+
+    std::shared_ptr<ReorderCache> cache_; // null: every call anneals from scratch
+
+    std::shared_ptr<Placement> placement_; // null: cnot count, otherwise layers on the grid
+
     void init();
 
+    void anneal(const std::vector<util::xor_func>& preparation,
+                const std::vector<util::xor_func>& start_prep,
+                const Schedule& schedule,
+                Chain& chain) const;
+
+    std::vector<util::xor_func> search(const std::vector<util::xor_func>& preparation,
+                                       const std::vector<util::xor_func>& start_prep);
+
 public:
     MatrixReconstructor(std::vector<util::xor_func>& input,
                        const int dimension,
-                       const int num_qubit)
+                       const int num_qubit,
+                       const util::Option& option,
+                       const Layout& layout,
+                       const std::shared_ptr<ReorderCache>& cache = nullptr)
         : input_(input),
           dimension_(dimension),
-          num_qubit_(num_qubit)
+          num_qubit_(num_qubit),
+          num_chain_(option.num_sa_chain()),
+          budget_(option.sa_budget()),
+          cache_(cache),
+          placement_(option.sa_cost() == ReorderCost::klayer ? std::make_shared<Placement>(layout) : nullptr)
     {
         init();
     }
@@ -0,0 +1,156 @@
+#ifndef T_SCHEDULING_REORDER_CACHE_HPP
+#define T_SCHEDULING_REORDER_CACHE_HPP
+
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <boost/functional/hash.hpp>
+
+#include "../util/util.hpp"
+
+namespace tskd {
+
+/**
+ * best row orders found by MatrixReconstructor, keyed by matrix content
+ * the search space of a call is every order of the rows of its initial
+ * preparation, so two calls with the same preparation and the same row set
+ * share their answer whatever the row order they come with
+ * not thread-safe, it is used by one builder at a time
+ */
+class ReorderCache
+{
+private:
+    struct Key
+    {
+        std::vector<util::xor_func> preparation;
+        std::vector<util::xor_func> rows; // sorted
+
+        bool operator==(const Key& other) const
+        {
+            return preparation == other.preparation && rows == other.rows;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const
+        {
+            size_t seed = 0;
+            for (auto&& row : key.preparation)
+            {
+                boost::hash_combine(seed, boost::hash_value(row));
+            }
+            for (auto&& row : key.rows)
+            {
+                boost::hash_combine(seed, boost::hash_value(row));
+            }
+
+            return seed;
+        }
+    };
+
+    using PreparationHash = boost::hash<std::vector<util::xor_func>>;
+
+    std::unordered_map<Key, std::vector<util::xor_func>, KeyHash> best_;
+    std::unordered_map<std::vector<util::xor_func>, std::vector<util::xor_func>, PreparationHash> last_; // [preparation] last best order
+
+    static Key make_key(const std::vector<util::xor_func>& preparation,
+                        const std::vector<util::xor_func>& init_prep)
+    {
+        Key key{preparation, init_prep};
+        std::sort(key.rows.begin(), key.rows.end());
+
+        return key;
+    }
+
+public:
+    ReorderCache() = default;
+
+    /**
+     * look up the best order of the rows of init_prep
+     * @param preparation preparation of the call
+     * @param init_prep initial row order
+     * @param best_prep best known order, set on a hit
+     * @return true on a hit
+     */
+    bool find(const std::vector<util::xor_func>& preparation,
+              const std::vector<util::xor_func>& init_prep,
+              std::vector<util::xor_func>& best_prep) const
+    {
+        auto it = best_.find(make_key(preparation, init_prep));
+        if (it == best_.end())
+        {
+            return false;
+        }
+        best_prep = it->second;
+
+        return true;
+    }
+
+    /**
+     * order the rows of init_prep like the last best order under the same preparation
+     * rows it does not share keep their relative order in the free positions
+     * @param preparation preparation of the call
+     * @param init_prep initial row order
+     * @return warm start order, init_prep when nothing is known
+     */
+    std::vector<util::xor_func> warm_start(const std::vector<util::xor_func>& preparation,
+                                           const std::vector<util::xor_func>& init_prep) const
+    {
+        auto it = last_.find(preparation);
+        if (it == last_.end() || it->second.size() != init_prep.size())
+        {
+            return init_prep;
+        }
+
+        const std::vector<util::xor_func>& last = it->second;
+        std::vector<int> row_map(last.size(), -1);
+        util::match_parities(last, init_prep, row_map);
+
+        std::vector<util::xor_func> ret(init_prep.size());
+        std::vector<bool> placed(init_prep.size(), false);
+        std::vector<bool> used(init_prep.size(), false);
+        for (size_t i = 0; i < last.size(); i++)
+        {
+            if (row_map[i] != -1)
+            {
+                ret[i] = init_prep[row_map[i]];
+                placed[i] = true;
+                used[row_map[i]] = true;
+            }
+        }
+        for (size_t i = 0, j = 0; i < ret.size(); i++)
+        {
+            if (placed[i])
+            {
+                continue;
+            }
+            while (used[j])
+            {
+                j++;
+            }
+            ret[i] = init_prep[j];
+            used[j] = true;
+        }
+
+        return ret;
+    }
+
+    /**
+     * record the best order found for a call
+     * @param preparation preparation of the call
+     * @param init_prep initial row order
+     * @param best_prep best order found
+     */
+    void store(const std::vector<util::xor_func>& preparation,
+               const std::vector<util::xor_func>& init_prep,
+               const std::vector<util::xor_func>& best_prep)
+    {
+        best_[make_key(preparation, init_prep)] = best_prep;
+        last_[preparation] = best_prep;
+    }
+};
+
+}
+
+#endif //T_SCHEDULING_REORDER_CACHE_HPP
@@ -0,0 +1,42 @@
+#ifndef T_SCHEDULING_ORACLE_BACKEND_HPP
+#define T_SCHEDULING_ORACLE_BACKEND_HPP
+
+#include <vector>
+
+namespace tskd {
+
+/**
+ * one query of ParallelizationOracle on the nodes and edges of its layout
+ * the query is satisfiable if some edges can be selected and every node
+ * labelled so that
+ * - a qubit node is labelled with its gate, or 0 if it is not in the query,
+ *   and has one selected edge if it is in the query, none otherwise
+ * - an ancilla node is labelled 1..num_gate and has 0 or at least 2 selected edges
+ * - a selected edge joins nodes of the same label and is not removed
+ * nodes with fewer than 2 edges are free of the edge count rules
+ */
+struct OracleQuery
+{
+    int num_gate = 0;
+    std::vector<int> label;      // [node id] gate of a qubit node, 0: not in the query; unused for ancillas
+    std::vector<bool> edge_off;  // [edge id] the edge is removed
+};
+
+/**
+ * solver answering the queries of ParallelizationOracle
+ */
+class OracleBackend
+{
+public:
+    virtual ~OracleBackend() = default;
+
+    /**
+     * @param query query
+     * @return true if the query is satisfiable
+     */
+    virtual bool solve(const OracleQuery& query) = 0;
+};
+
+}
+
+#endif //T_SCHEDULING_ORACLE_BACKEND_HPP
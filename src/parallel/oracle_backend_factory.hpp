@@ -0,0 +1,40 @@
+#ifndef T_SCHEDULING_ORACLE_BACKEND_FACTORY_HPP
+#define T_SCHEDULING_ORACLE_BACKEND_FACTORY_HPP
+
+#include <memory>
+
+#include "oracle_backend.hpp"
+#include "sat_backend.hpp"
+#ifdef TSKD_WITH_Z3
+#include "z3_backend.hpp"
+#endif
+
+#include "../util/option.hpp"
+
+#include "../layout/layout.hpp"
+
+namespace tskd {
+
+class OracleBackendFactory
+{
+public:
+    OracleBackendFactory() = default;
+
+    std::unique_ptr<OracleBackend> create(const OracleBackendType backend_type,
+                                          const Layout& layout)
+    {
+        switch (backend_type)
+        {
+#ifdef TSKD_WITH_Z3
+            case OracleBackendType::kz3:
+                return std::unique_ptr<OracleBackend>(new Z3Backend(layout, layout.option().oracle_encoding()));
+#endif
+            default:
+                return std::unique_ptr<OracleBackend>(new SatBackend(layout));
+        }
+    }
+};
+
+}
+
+#endif //T_SCHEDULING_ORACLE_BACKEND_FACTORY_HPP
@@ -1,256 +1,132 @@
+#include <algorithm>
+
 #include "parallelization_oracle.hpp"
+#include "oracle_backend_factory.hpp"
 
 namespace tskd {
 
-void ParallelizationOracle::init(const std::list<Gate>& gate_list)
+ParallelizationOracle::Shared::Shared(const Layout& layout)
+        : layout(layout),
+          backend_type(layout.option().oracle_backend())
 {
-    int id = 1;
-    for (auto&& gate : gate_list)
+    for (auto&& node : layout.node_list())
     {
-        // store control qubit name
-        for (auto&& name : gate.control_list())
-        {
-            control_qubit_map_.emplace(name, id);
-            related_qubit_id_map_.emplace(name, id);
-        }
-
-        // store target qubit name
-        for (auto&& name : gate.target_list())
-        {
-            target_qubit_map_.emplace(name, id);
-            related_qubit_id_map_.emplace(name, id);
-        }
-        id++;
+        is_ancilla.push_back(node->name() == "A");
     }
-}
 
-void ParallelizationOracle::make_vars(z3::context& context,
-                                      z3::expr_vector& edge_expr_array,
-                                      z3::expr_vector& node_expr_array)
-{
-    // make edge variables
-    for (size_t i = 0; i < layout_.edge_list().size(); i++)
+    /*
+     * horizontal edges at controls and vertical edges at targets are removed,
+     * unless both ends are ancillas; only those edges are listed
+     */
+    for (auto&& edge : layout.horizontal_edge_list())
     {
-        edge_expr_array.push_back(context.int_const(std::to_string(new_variable()).c_str()));
+        if (edge->node_a()->name() != "A" || edge->node_b()->name() != "A")
+        {
+            horizontal_edge.emplace_back(edge->id(), edge->node_a()->id());
+            horizontal_edge.emplace_back(edge->id(), edge->node_b()->id());
+        }
     }
-
-    // make node id variables
-    for (size_t i = 0; i < layout_.node_list().size(); i++)
+    for (auto&& edge : layout.vertical_edge_list())
     {
-        node_expr_array.push_back(context.int_const(std::to_string(new_variable()).c_str()));
+        if (edge->node_a()->name() != "A" || edge->node_b()->name() != "A")
+        {
+            vertical_edge.emplace_back(edge->id(), edge->node_a()->id());
+            vertical_edge.emplace_back(edge->id(), edge->node_b()->id());
+        }
     }
 }
 
-void ParallelizationOracle::make_base_constraint(z3::solver& solver,
-                                                 z3::expr_vector& edge_expr_array,
-                                                 z3::expr_vector& node_expr_array)
+ParallelizationOracle::Context& ParallelizationOracle::context() const
 {
-    make_range_constraint(solver, edge_expr_array, node_expr_array);
-
-    make_edge_constraints(solver, edge_expr_array);
-
-    make_adj_nodes_constraint(solver, edge_expr_array, node_expr_array);
-
-    make_remove_edge_constraint(solver, edge_expr_array);
+    return context_.get([this]() {
+        return std::unique_ptr<Context>(new Context(shared_->layout));
+    });
 }
 
-void ParallelizationOracle::make_range_constraint(z3::solver& solver,
-                                                    z3::expr_vector& edge_expr_array,
-                                                    z3::expr_vector& node_expr_array)
+bool ParallelizationOracle::route(Context& ctx,
+                                  const std::list<Gate>& gate_list)
 {
-    for (auto&& node : layout_.node_list())
+    ctx.gate_route.resize(gate_list.size());
+    auto it = ctx.gate_route.begin();
+    for (auto&& gate : gate_list)
     {
-        if (node->name() == "A")
+        it->control = gate.control_list().empty() ? -1 : ctx.router.node(gate.control_list().front());
+        it->target_list.clear();
+        for (auto&& name : gate.target_list())
         {
-            z3::expr e =  node_expr_array[node->id()];
-            solver.add(1 <= e && e <= num_gate_);
+            it->target_list.push_back(ctx.router.node(name));
         }
-        else
+        if (it->control == -1 || gate.control_list().size() != 1
+            || std::count(it->target_list.begin(), it->target_list.end(), -1) > 0)
         {
-            if (related_qubit_id_map_.count(node->name()))
-            {
-                z3::expr e =  node_expr_array[node->id()];
-                solver.add(e == related_qubit_id_map_[node->name()]);
-            }
-            else
-            {
-                z3::expr e =  node_expr_array[node->id()];
-                solver.add(e == 0);
-            }
+            // not a multi-target cnot on the layout, left to the backend
+            return false;
         }
+        ++it;
     }
 
-    for (auto&& edge : layout_.edge_list())
-    {
-        z3::expr e =  edge_expr_array[edge->id()];
-        solver.add(0 <= e && e <= 1);
-    }
+    return ctx.router.route(ctx.gate_route, ctx.witness);
 }
 
-void ParallelizationOracle::make_edge_constraints(z3::solver& solver,
-                                                  z3::expr_vector& edge_expr_array)
+void ParallelizationOracle::make_query(Context& ctx,
+                                       const std::list<Gate>& gate_list) const
 {
-    for (auto&& node : layout_.node_list())
+    const Shared& shared = *shared_;
+    const size_t num_node = shared.is_ancilla.size();
+
+    OracleQuery& query = ctx.query;
+    query.num_gate = static_cast<int>(gate_list.size());
+    query.label.assign(num_node, 0);
+    query.edge_off.assign(shared.layout.edge_list().size(), false);
+    ctx.is_control.assign(num_node, false);
+    ctx.is_target.assign(num_node, false);
+
+    /*
+     * label the qubits of each gate with its id, from 1; a qubit keeps the
+     * first gate it appears in
+     */
+    int id = 1;
+    for (auto&& gate : gate_list)
     {
-        const int num_connected_edge = static_cast<int>(node->edge_list().size());
-        if (node->name() != "A")
+        for (auto&& name : gate.control_list())
         {
-            if (related_qubit_id_map_.count(node->name()))
+            const int node = ctx.router.node(name);
+            if (node != -1)
             {
-                if (num_connected_edge == 4)
-                {
-                    z3::expr e1 =  edge_expr_array[node->edge_list()[0]->id()];
-                    z3::expr e2 =  edge_expr_array[node->edge_list()[1]->id()];
-                    z3::expr e3 =  edge_expr_array[node->edge_list()[2]->id()];
-                    z3::expr e4 =  edge_expr_array[node->edge_list()[3]->id()];
-
-                    solver.add((e1 + e2 + e3 + e4) == 1);
-                }
-                if (num_connected_edge == 3)
-                {
-                    z3::expr e1 =  edge_expr_array[node->edge_list()[0]->id()];
-                    z3::expr e2 =  edge_expr_array[node->edge_list()[1]->id()];
-                    z3::expr e3 =  edge_expr_array[node->edge_list()[2]->id()];
-
-                    solver.add((e1 + e2 + e3) == 1);
-                }
-                if (num_connected_edge == 2)
-                {
-                    z3::expr e1 =  edge_expr_array[node->edge_list()[0]->id()];
-                    z3::expr e2 =  edge_expr_array[node->edge_list()[1]->id()];
-
-                    solver.add((e1 + e2) == 1);
-                }
-            }
-            else
-            {
-                if (num_connected_edge == 4)
-                {
-                    z3::expr e1 =  edge_expr_array[node->edge_list()[0]->id()];
-                    z3::expr e2 =  edge_expr_array[node->edge_list()[1]->id()];
-                    z3::expr e3 =  edge_expr_array[node->edge_list()[2]->id()];
-                    z3::expr e4 =  edge_expr_array[node->edge_list()[3]->id()];
-
-                    solver.add((e1 + e2 + e3 + e4) == 0);
-                }
-                if (num_connected_edge == 3)
-                {
-                    z3::expr e1 =  edge_expr_array[node->edge_list()[0]->id()];
-                    z3::expr e2 =  edge_expr_array[node->edge_list()[1]->id()];
-                    z3::expr e3 =  edge_expr_array[node->edge_list()[2]->id()];
-
-                    solver.add((e1 + e2 + e3) == 0);
-                }
-                if (num_connected_edge == 2)
-                {
-                    z3::expr e1 =  edge_expr_array[node->edge_list()[0]->id()];
-                    z3::expr e2 =  edge_expr_array[node->edge_list()[1]->id()];
-
-                    solver.add((e1 + e2) == 0);
-                }
+                ctx.is_control[node] = true;
+                query.label[node] = query.label[node] == 0 ? id : query.label[node];
             }
         }
-        else
+        for (auto&& name : gate.target_list())
         {
-            if (num_connected_edge == 4)
+            const int node = ctx.router.node(name);
+            if (node != -1)
             {
-                z3::expr e1 =  edge_expr_array[node->edge_list()[0]->id()];
-                z3::expr e2 =  edge_expr_array[node->edge_list()[1]->id()];
-                z3::expr e3 =  edge_expr_array[node->edge_list()[2]->id()];
-                z3::expr e4 =  edge_expr_array[node->edge_list()[3]->id()];
-
-                solver.add((e1 + e2 + e3 + e4) == 0
-                ||  (e1 + e2 + e3 + e4) == 2
-                || (e1 + e2 + e3 + e4) == 3
-                || (e1 + e2 + e3 + e4) == 4);
-            }
-            if (num_connected_edge == 3)
-            {
-                z3::expr e1 =  edge_expr_array[node->edge_list()[0]->id()];
-                z3::expr e2 =  edge_expr_array[node->edge_list()[1]->id()];
-                z3::expr e3 =  edge_expr_array[node->edge_list()[2]->id()];
-
-                solver.add((e1 + e2 + e3) == 0 ||  (e1 + e2 + e3) == 2 || (e1 + e2 + e3) == 3);
-            }
-            if (num_connected_edge == 2)
-            {
-                z3::expr e1 =  edge_expr_array[node->edge_list()[0]->id()];
-                z3::expr e2 =  edge_expr_array[node->edge_list()[1]->id()];
-
-                solver.add((e1 + e2) == 0 ||  (e1 + e2) == 2);
+                ctx.is_target[node] = true;
+                query.label[node] = query.label[node] == 0 ? id : query.label[node];
             }
         }
+        id++;
     }
-}
-
-void ParallelizationOracle::make_adj_nodes_constraint(z3::solver& solver,
-                                                      z3::expr_vector& edge_expr_array,
-                                                      z3::expr_vector& node_expr_array)
-{
-    for (auto&& edge : layout_.edge_list())
-    {
-        z3::expr edge_expr = edge_expr_array[edge->id()];
-        z3::expr node_expr1 = node_expr_array[edge->node_a()->id()];
-        z3::expr node_expr2 = node_expr_array[edge->node_b()->id()];
-
-        solver.add(z3::implies(edge_expr == 1, node_expr1 == node_expr2));
-    }
-}
 
-void ParallelizationOracle::make_remove_edge_constraint(z3::solver& solver,
-                                                        z3::expr_vector& edge_expr_array)
-{
-    for (auto&& edge : layout_.horizontal_edge_list())
+    for (auto&& edge : shared.horizontal_edge)
     {
-        const int count = control_qubit_map_.count(edge->node_a()->name()) + control_qubit_map_.count(edge->node_b()->name());
-        if ((edge->node_a()->name() != "A" || edge->node_b()->name() != "A") && count > 0)
+        if (ctx.is_control[edge.second])
         {
-            z3::expr e = edge_expr_array[edge->id()];
-
-            solver.add(e == 0);
+            query.edge_off[edge.first] = true;
         }
     }
-
-    for (auto&& edge : layout_.vertical_edge_list())
+    for (auto&& edge : shared.vertical_edge)
     {
-        const int count = target_qubit_map_.count(edge->node_a()->name()) + target_qubit_map_.count(edge->node_b()->name());
-        if ((edge->node_a()->name() != "A" || edge->node_b()->name() != "A") && count > 0)
+        if (ctx.is_target[edge.second])
         {
-            z3::expr e = edge_expr_array[edge->id()];
-
-            solver.add(e == 0);
+            query.edge_off[edge.first] = true;
         }
     }
 }
 
-void ParallelizationOracle::verification(z3::solver& s)
-{
-    z3::model m = s.get_model();
-
-    std::vector<int> node_var(m.size() + 1);
-    std::vector<int> edge_var(m.size() + 1);
-
-    // traversing the model
-    for (unsigned i = 0; i < m.size(); i++) {
-        z3::func_decl v = m[i];
-        assert(v.arity() == 0);
-        node_var[std::stoi(v.name().str())] = m.get_const_interp(v).get_numeral_int();
-        edge_var[std::stoi(v.name().str())] = m.get_const_interp(v).get_numeral_int();
-    }
-
-    for (int y = 0; y < layout_.height(); y++)
-    {
-        for (int x = 0; x < layout_.width(); x++)
-        {
-            int index = layout_.edge_list().size() + 1 + (y * layout_.width()) + x;
-            std::cout << node_var[index];
-        }
-        std::cout << std::endl;
-    }
-}
-
 bool ParallelizationOracle::check(std::list<Gate>& gate_list,
-                                  const Gate& new_gate)
+                                  const Gate& new_gate) const
 {
     gate_list.push_back(new_gate);
 
@@ -261,28 +137,49 @@ bool ParallelizationOracle::check(std::list<Gate>& gate_list,
     return result;
 }
 
-bool ParallelizationOracle::check(const std::list<Gate>& gate_list)
+bool ParallelizationOracle::solve(Context& ctx,
+                                  const std::list<Gate>& gate_list) const
 {
-    num_gate_ = static_cast<int>(gate_list.size());
+    ctx.witness.clear();
+
+    if (gate_list.size() == 1)
+    {
+        return true;
+    }
 
-    if (num_gate_ == 1)
+    /*
+     * disjoint routes found by Router are a solution, so the backend only
+     * has to answer the queries the router fails on
+     */
+    if (route(ctx, gate_list))
     {
         return true;
     }
+    ctx.witness.clear();
 
-    init(gate_list);
+    make_query(ctx, gate_list);
 
-    z3::context c;
-    z3::expr_vector edge_expr_array(c);
-    z3::expr_vector node_expr_array(c);
+    if (!ctx.backend)
+    {
+        ctx.backend = OracleBackendFactory().create(shared_->backend_type, shared_->layout);
+    }
 
-    make_vars(c, edge_expr_array, node_expr_array);
+    return ctx.backend->solve(ctx.query);
+}
 
-    z3::solver s(c);
+bool ParallelizationOracle::check(const std::list<Gate>& gate_list) const
+{
+    return solve(context(), gate_list);
+}
 
-    make_base_constraint(s, edge_expr_array, node_expr_array);
+bool ParallelizationOracle::check(const std::list<Gate>& gate_list,
+                                  std::vector<Route>& witness) const
+{
+    Context& ctx = context();
+    const bool result = solve(ctx, gate_list);
+    witness = ctx.witness;
 
-    return s.check() == z3::sat;
+    return result;
 }
 
-}
\ No newline at end of file
+}
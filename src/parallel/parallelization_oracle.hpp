@@ -2,72 +2,103 @@
 #define T_SCHEDULING_PARALLELIZATION_ORACLE_HPP
 
 #include <list>
+#include <memory>
+#include <vector>
+#include <utility>
 
-#include "z3++.h"
+#include "router.hpp"
+#include "oracle_backend.hpp"
 
 #include "../circuit/gate.hpp"
 
+#include "../util/per_thread.hpp"
+
 #include "../layout/layout.hpp"
 
 namespace tskd {
 
+/**
+ * can multi-target cnots run together on the layout
+ * a query keeps its state on the stack and in the context of the calling
+ * thread, so check() may be called from several threads at once; copies
+ * share the layout and the contexts
+ */
 class ParallelizationOracle
 {
 private:
-    Layout layout_;
-
-    int num_gate_;
+    /**
+     * layout and its tables, never modified after construction
+     */
+    struct Shared
+    {
+        Layout layout;
+        OracleBackendType backend_type;
 
-    std::unordered_map<std::string, int> control_qubit_map_;    // <control qubit name, id of gate>
-    std::unordered_map<std::string, int> target_qubit_map_;     // <target  qubit name, id of gate>
-    std::unordered_map<std::string, int> related_qubit_id_map_; // <related qubit name, id of gate>
+        std::vector<bool> is_ancilla;                        // [node id]
+        std::vector<std::pair<int, int>> horizontal_edge;    // <edge id, node id of an end>, one entry per end
+        std::vector<std::pair<int, int>> vertical_edge;      // <edge id, node id of an end>, one entry per end
 
-    int var_count_;
+        explicit Shared(const Layout& layout);
+    };
 
-    void init(const std::list<Gate>& gate_list);
+    /**
+     * working state of a thread: router scratch, backend and query buffers
+     */
+    struct Context
+    {
+        Router router;
+        std::unique_ptr<OracleBackend> backend; // built on the first query the router fails on
 
-    void make_vars(z3::context& context,
-                   z3::expr_vector& edge_expr_array,
-                   z3::expr_vector& node_expr_array);
+        std::vector<Route> gate_route; // control and targets of the gates of a query
+        std::vector<Route> witness;    // routes of the last query, when the router answered it
+        std::vector<char> is_control;  // [node id]
+        std::vector<char> is_target;   // [node id]
+        OracleQuery query;
 
-    void make_base_constraint(z3::solver& solver,
-                              z3::expr_vector& edge_expr_array,
-                              z3::expr_vector& node_expr_array);
+        explicit Context(const Layout& layout)
+                : router(layout) { }
+    };
 
-    void make_range_constraint(z3::solver& solver,
-                               z3::expr_vector& edge_expr_array,
-                               z3::expr_vector& node_expr_array);
+    std::shared_ptr<const Shared> shared_;
 
-    void make_edge_constraints(z3::solver& solver,
-                               z3::expr_vector& edge_expr_array);
+    util::PerThread<Context> context_;
 
-    void make_adj_nodes_constraint(z3::solver& solver,
-                                   z3::expr_vector& edge_expr_array,
-                                   z3::expr_vector& node_expr_array);
+    Context& context() const;
 
-    void make_remove_edge_constraint(z3::solver& solver,
-                                     z3::expr_vector& edge_expr_array);
+    static bool route(Context& ctx,
+                      const std::list<Gate>& gate_list);
 
-    inline int new_variable()
-    {
-        var_count_ += 1;
+    void make_query(Context& ctx,
+                    const std::list<Gate>& gate_list) const;
 
-        return var_count_;
-    }
-
-    void verification(z3::solver& s);
+    bool solve(Context& ctx,
+               const std::list<Gate>& gate_list) const;
 
 public:
     ParallelizationOracle() = default;
 
-    ParallelizationOracle(const Layout& layout)
-        : layout_(layout),
-          var_count_(0) { }
+    explicit ParallelizationOracle(const Layout& layout)
+        : shared_(std::make_shared<const Shared>(layout)) { }
 
-    bool check(std::list<Gate>& gate_list,
-               const Gate& new_gate);
+    const Layout& layout() const
+    {
+        return shared_->layout;
+    }
 
-    bool check(const std::list<Gate>& gate_list);
+    bool check(std::list<Gate>& gate_list,
+               const Gate& new_gate) const;
+
+    bool check(const std::list<Gate>& gate_list) const;
+
+    /**
+     * check, with the routes of the gates when Router answered the query
+     * @param gate_list gates
+     * @param witness routes in node ids and in the order of the gates;
+     *                empty when the backend answered
+     * @return true if the gates can run together
+     */
+    bool check(const std::list<Gate>& gate_list,
+               std::vector<Route>& witness) const;
 };
 
 }
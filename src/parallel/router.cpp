@@ -0,0 +1,190 @@
+#include "router.hpp"
+
+namespace tskd {
+
+Router::Router(const Layout& layout)
+{
+    width_ = layout.width();
+    height_ = layout.height();
+
+    // node ids follow the grid in row-major order
+    is_data_.assign(static_cast<size_t>(width_) * height_, false);
+    for (auto&& node : layout.node_list())
+    {
+        if (node->type() == NodeType::kdata)
+        {
+            is_data_[node->id()] = true;
+            data_node_.emplace(node->name(), node->id());
+        }
+    }
+
+    prev_.assign(is_data_.size(), -1);
+    queue_.reserve(is_data_.size());
+    in_tree_.assign(is_data_.size(), false);
+}
+
+bool Router::connect(const std::vector<int>& owner,
+                     Route& route,
+                     int target)
+{
+    if (owner[route.control] != -1 || owner[target] != -1)
+    {
+        return false;
+    }
+
+    for (auto&& id : route.tree)
+    {
+        in_tree_[id] = true;
+    }
+    auto is_free = [&](int id) { return !is_data_[id] && owner[id] == -1 && !in_tree_[id]; };
+
+    /*
+     * sources: the route so far, or the patches above and below the control
+     */
+    queue_.clear();
+    std::fill(prev_.begin(), prev_.end(), -1);
+    if (route.tree.empty())
+    {
+        for (int dy : {-1, 1})
+        {
+            const int y = route.control / width_ + dy;
+            const int id = y * width_ + route.control % width_;
+            if (0 <= y && y < height_ && is_free(id))
+            {
+                prev_[id] = id;
+                queue_.push_back(id);
+            }
+        }
+    }
+    else
+    {
+        for (auto&& id : route.tree)
+        {
+            prev_[id] = id;
+            queue_.push_back(id);
+        }
+    }
+
+    /*
+     * breadth-first search to a patch left or right of the target
+     */
+    const int tx = target % width_;
+    const int ty = target / width_;
+    int goal = -1;
+    for (size_t head = 0; head < queue_.size(); head++)
+    {
+        const int u = queue_[head];
+        const int ux = u % width_;
+        const int uy = u / width_;
+        if (uy == ty && (ux == tx - 1 || ux == tx + 1))
+        {
+            goal = u;
+
+            break;
+        }
+
+        const int next[4][2] = {{ux + 1, uy}, {ux - 1, uy}, {ux, uy + 1}, {ux, uy - 1}};
+        for (auto&& n : next)
+        {
+            if (n[0] < 0 || n[0] >= width_ || n[1] < 0 || n[1] >= height_)
+            {
+                continue;
+            }
+            const int v = n[1] * width_ + n[0];
+            if (prev_[v] == -1 && is_free(v))
+            {
+                prev_[v] = u;
+                queue_.push_back(v);
+            }
+        }
+    }
+
+    // walk back to the route so far
+    for (int v = goal; v != -1 && !in_tree_[v]; v = (prev_[v] == v) ? -1 : prev_[v])
+    {
+        route.tree.push_back(v);
+        in_tree_[v] = true;
+    }
+    for (auto&& id : route.tree)
+    {
+        in_tree_[id] = false;
+    }
+    if (goal == -1)
+    {
+        return false;
+    }
+    route.target_list.push_back(target);
+
+    return true;
+}
+
+bool Router::build(const std::vector<int>& owner,
+                   Route& route,
+                   const std::vector<int>& target_list)
+{
+    route.target_list.clear();
+    route.tree.clear();
+    for (auto&& target : target_list)
+    {
+        if (!connect(owner, route, target))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Router::place(std::vector<int>& owner,
+                   const Route& route,
+                   int gate)
+{
+    owner[route.control] = gate;
+    for (auto&& id : route.target_list)
+    {
+        owner[id] = gate;
+    }
+    for (auto&& id : route.tree)
+    {
+        owner[id] = gate;
+    }
+}
+
+bool Router::route(const std::vector<Route>& gate_list,
+                   std::vector<Route>& route_list)
+{
+    const int num_gate = static_cast<int>(gate_list.size());
+    route_list.resize(num_gate);
+
+    // -1: the given order, otherwise the gate routed first
+    for (int first = -1; first < num_gate; first++)
+    {
+        if (first == 0)
+        {
+            // same as the given order
+            continue;
+        }
+
+        owner_.assign(is_data_.size(), -1);
+        bool routed = true;
+        for (int k = 0; k < num_gate && routed; k++)
+        {
+            // the first gate, then the others in order
+            const int i = (first == -1) ? k : (k == 0) ? first : (k <= first) ? k - 1 : k;
+            route_list[i].control = gate_list[i].control;
+            routed = build(owner_, route_list[i], gate_list[i].target_list);
+            if (routed)
+            {
+                place(owner_, route_list[i], i);
+            }
+        }
+        if (routed)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+}
@@ -0,0 +1,111 @@
+#ifndef T_SCHEDULING_ROUTER_HPP
+#define T_SCHEDULING_ROUTER_HPP
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include "../layout/layout.hpp"
+
+namespace tskd {
+
+/**
+ * route of one multi-target cnot, in node ids of the layout
+ */
+struct Route
+{
+    int control = -1;
+    std::vector<int> target_list;
+    std::vector<int> tree; // ancilla patches
+};
+
+/**
+ * breadth-first router of multi-target cnots over the ancilla patches
+ * a route leaves the control through a vertical edge and enters each target
+ * through a horizontal edge, as ParallelizationOracle requires, so routes
+ * on disjoint patches are a solution of the oracle
+ */
+class Router
+{
+private:
+    int width_ = 0;
+    int height_ = 0;
+
+    std::vector<bool> is_data_;                      // [node id]
+    std::unordered_map<std::string, int> data_node_; // <qubit name, node id>
+
+    // bfs scratch
+    std::vector<int> prev_;
+    std::vector<int> queue_;
+    std::vector<bool> in_tree_;
+
+    std::vector<int> owner_; // scratch of route()
+
+public:
+    Router() = default;
+
+    explicit Router(const Layout& layout);
+
+    int num_node() const
+    {
+        return static_cast<int>(is_data_.size());
+    }
+
+    /**
+     * node of a qubit
+     * @param name qubit name
+     * @return node id, -1 if the qubit is not on the layout
+     */
+    int node(const std::string& name) const
+    {
+        auto it = data_node_.find(name);
+
+        return it == data_node_.end() ? -1 : it->second;
+    }
+
+    /**
+     * extend a route to one more target through free patches
+     * @param owner [node id] gate using the node, -1: free
+     * @param route route with its control set, extended on success
+     * @param target target node
+     * @return true if a path was found
+     */
+    bool connect(const std::vector<int>& owner,
+                 Route& route,
+                 int target);
+
+    /**
+     * route a gate from its control
+     * @param owner [node id] gate using the node, -1: free
+     * @param route route with its control set, rebuilt
+     * @param target_list target nodes
+     * @return true if every target was reached
+     */
+    bool build(const std::vector<int>& owner,
+               Route& route,
+               const std::vector<int>& target_list);
+
+    /**
+     * mark the nodes of a route
+     * @param owner [node id] gate using the node
+     * @param route route
+     * @param gate gate id
+     */
+    static void place(std::vector<int>& owner,
+                      const Route& route,
+                      int gate);
+
+    /**
+     * route gates together on an empty layer, in the given order and then
+     * with each gate first
+     * @param gate_list gates with their control and targets set
+     * @param route_list routes in the order of gate_list, set on success
+     * @return true if every gate was routed
+     */
+    bool route(const std::vector<Route>& gate_list,
+               std::vector<Route>& route_list);
+};
+
+}
+
+#endif //T_SCHEDULING_ROUTER_HPP
@@ -0,0 +1,147 @@
+#include "routing_scheduler.hpp"
+
+namespace tskd {
+
+void RoutingScheduler::init()
+{
+    wire_node_.clear();
+    for (auto&& name : qubit_names_)
+    {
+        wire_node_.push_back(router_.node(name));
+    }
+}
+
+RoutingScheduler::Layer& RoutingScheduler::layer(int index)
+{
+    while (num_layer_ <= index)
+    {
+        if (num_layer_ == static_cast<int>(layer_list_.size()))
+        {
+            layer_list_.emplace_back();
+        }
+        Layer& l = layer_list_[num_layer_++];
+        l.owner.assign(router_.num_node(), -1);
+        l.route_list.clear();
+        l.sealed = false;
+        l.pending = Route();
+    }
+
+    return layer_list_[index];
+}
+
+bool RoutingScheduler::reroute(Layer& layer,
+                               const Route& candidate)
+{
+    /*
+     * route the layer again with the candidate, in any order the router tries
+     */
+    std::vector<Route> gate_list(layer.route_list);
+    gate_list.push_back(candidate);
+    std::vector<Route> route_list;
+    if (!router_.route(gate_list, route_list))
+    {
+        return false;
+    }
+
+    // the candidate stays pending until it is committed
+    layer.pending = route_list.back();
+    route_list.pop_back();
+    layer.owner.assign(router_.num_node(), -1);
+    for (size_t i = 0; i < route_list.size(); i++)
+    {
+        Router::place(layer.owner, route_list[i], static_cast<int>(i));
+    }
+    layer.route_list = route_list;
+
+    return true;
+}
+
+bool RoutingScheduler::check(std::list<Gate>& gate_list,
+                             int index,
+                             int control,
+                             const std::vector<int>& target_list)
+{
+    // the oracle works on named gates
+    auto new_gate = [&]()
+    {
+        std::vector<std::string> name_list;
+        for (auto&& target : target_list)
+        {
+            name_list.push_back(qubit_names_[target]);
+        }
+
+        return Gate("tof", qubit_names_[control], name_list);
+    };
+
+    Layer& l = layer(index);
+    if (l.sealed)
+    {
+        return oracle_.check(gate_list, new_gate());
+    }
+
+    Route& candidate = candidate_;
+    candidate.control = wire_node_[control];
+    candidate.target_list.clear();
+    for (auto&& target : target_list)
+    {
+        candidate.target_list.push_back(wire_node_[target]);
+    }
+
+    /*
+     * extend the pending gate, or route the candidate from scratch
+     */
+    const bool extends = l.pending.control == candidate.control
+                         && l.pending.target_list.size() + 1 == candidate.target_list.size()
+                         && std::equal(l.pending.target_list.begin(), l.pending.target_list.end(),
+                                       candidate.target_list.begin());
+    Route& route = route_;
+    if (extends)
+    {
+        route = l.pending;
+    }
+    else
+    {
+        route.target_list.clear();
+        route.tree.clear();
+    }
+    route.control = candidate.control;
+    const bool routed = extends ? router_.connect(l.owner, route, candidate.target_list.back())
+                                : router_.build(l.owner, route, candidate.target_list);
+    if (routed)
+    {
+        l.pending = route;
+
+        return true;
+    }
+
+    if (!gate_list.empty() && reroute(l, candidate))
+    {
+        return true;
+    }
+
+    /*
+     * a lone gate is always accepted, as by the oracle; otherwise the oracle
+     * decides, as it is not bound to the routes tried here
+     */
+    if (gate_list.empty() || oracle_.check(gate_list, new_gate()))
+    {
+        l.sealed = true;
+
+        return true;
+    }
+
+    return false;
+}
+
+void RoutingScheduler::commit(int index)
+{
+    Layer& l = layer(index);
+    if (!l.sealed && l.pending.control != -1)
+    {
+        Router::place(l.owner, l.pending, static_cast<int>(l.route_list.size()));
+        l.route_list.push_back(l.pending);
+    }
+    l.pending = Route();
+}
+
+}
@@ -0,0 +1,108 @@
+#ifndef T_SCHEDULING_ROUTING_SCHEDULER_HPP
+#define T_SCHEDULING_ROUTING_SCHEDULER_HPP
+
+#include <list>
+#include <algorithm>
+#include <vector>
+#include <string>
+
+#include "router.hpp"
+#include "parallelization_oracle.hpp"
+
+#include "../circuit/gate.hpp"
+
+#include "../layout/layout.hpp"
+
+namespace tskd {
+
+/**
+ * packs multi-target cnots into layers by routing them on the layout
+ * each layer keeps the ancilla patches taken by the routes of its gates, and
+ * a gate joins it when a route around them exists, i.e. first-fit colouring
+ * of the conflict graph over shared patches
+ * the routes are found by Router; when the new gate does not fit around the
+ * fixed routes, the whole layer is routed again in other orders; only if that
+ * fails too is the oracle asked, and a layer it accepts is sealed and checked
+ * by the oracle from then on
+ */
+class RoutingScheduler
+{
+private:
+    /**
+     * routes of one layer
+     */
+    struct Layer
+    {
+        std::vector<int> owner; // [node id] gate of the layer using it, -1: free
+        std::vector<Route> route_list;
+        bool sealed = false;
+
+        Route pending; // gate being built, extended one target per check
+    };
+
+    ParallelizationOracle oracle_; // shared with the other schedulers of the decomposer
+
+    Router router_;
+
+    std::vector<std::string> qubit_names_;
+
+    std::vector<int> wire_node_; // [wire] node id of its data qubit
+
+    std::vector<Layer> layer_list_; // reused across clear()
+    int num_layer_ = 0;
+
+    // scratch of check
+    Route candidate_;
+    Route route_;
+
+    void init();
+
+    Layer& layer(int index);
+
+    bool reroute(Layer& layer,
+                 const Route& candidate);
+
+public:
+    RoutingScheduler() = default;
+
+    RoutingScheduler(const ParallelizationOracle& oracle,
+                     const std::vector<std::string>& qubit_names)
+        : oracle_(oracle),
+          router_(oracle.layout()),
+          qubit_names_(qubit_names)
+    {
+        init();
+    }
+
+    /**
+     * forget every layer, keeping the buffers
+     */
+    void clear()
+    {
+        num_layer_ = 0;
+    }
+
+    /**
+     * can a multi-target cnot run in a layer
+     * it usually extends the gate last probed in the layer by one target
+     * @param gate_list gates of the layer
+     * @param index layer
+     * @param control control wire
+     * @param target_list target wires
+     * @return true if the layer can hold it
+     */
+    bool check(std::list<Gate>& gate_list,
+               int index,
+               int control,
+               const std::vector<int>& target_list);
+
+    /**
+     * add the gate last accepted by check to the layer
+     * @param index layer
+     */
+    void commit(int index);
+};
+
+}
+
+#endif //T_SCHEDULING_ROUTING_SCHEDULER_HPP
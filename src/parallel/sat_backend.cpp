@@ -0,0 +1,161 @@
+#include "sat_backend.hpp"
+
+namespace tskd {
+
+SatBackend::SatBackend(const Layout& layout)
+{
+    for (auto&& node : layout.node_list())
+    {
+        ancilla_.push_back(node->name() == "A");
+        std::vector<int> edge_id_list;
+        for (auto&& edge : node->edge_list())
+        {
+            edge_id_list.push_back(edge->id());
+        }
+        node_edge_.push_back(edge_id_list);
+    }
+
+    for (auto&& edge : layout.edge_list())
+    {
+        edge_node_.emplace_back(edge->node_a()->id(), edge->node_b()->id());
+    }
+
+    label_var_.assign(ancilla_.size(), -1);
+}
+
+void SatBackend::make_edge_clauses(SatSolver& solver,
+                                   const OracleQuery& query,
+                                   int num_gate)
+{
+    for (int e = 0; e < static_cast<int>(edge_node_.size()); e++)
+    {
+        const int a = edge_node_[e].first;
+        const int b = edge_node_[e].second;
+        const int used = SatSolver::neg(e); // clause literal: the edge is not selected
+
+        if (query.edge_off[e])
+        {
+            solver.add_clause({used});
+        }
+        else if (ancilla_[a] && ancilla_[b])
+        {
+            // the ancillas share their label
+            for (int g = 0; g < num_gate; g++)
+            {
+                solver.add_clause({used, SatSolver::neg(label_var_[a] + g), SatSolver::pos(label_var_[b] + g)});
+                solver.add_clause({used, SatSolver::neg(label_var_[b] + g), SatSolver::pos(label_var_[a] + g)});
+            }
+        }
+        else if (ancilla_[a] || ancilla_[b])
+        {
+            // the ancilla takes the gate of the qubit
+            const int ancilla = ancilla_[a] ? a : b;
+            const int gate = query.label[ancilla_[a] ? b : a];
+            if (gate == 0)
+            {
+                solver.add_clause({used});
+            }
+            else
+            {
+                solver.add_clause({used, SatSolver::pos(label_var_[ancilla] + gate - 1)});
+            }
+        }
+        else if (query.label[a] != query.label[b])
+        {
+            solver.add_clause({used});
+        }
+    }
+}
+
+void SatBackend::make_degree_clauses(SatSolver& solver,
+                                     const OracleQuery& query)
+{
+    for (int node = 0; node < static_cast<int>(node_edge_.size()); node++)
+    {
+        const std::vector<int>& edge_id_list = node_edge_[node];
+        if (edge_id_list.size() < 2)
+        {
+            continue;
+        }
+
+        if (ancilla_[node])
+        {
+            // no edge or at least two: a selected edge needs another
+            for (size_t i = 0; i < edge_id_list.size(); i++)
+            {
+                std::vector<int> clause{SatSolver::neg(edge_id_list[i])};
+                for (size_t j = 0; j < edge_id_list.size(); j++)
+                {
+                    if (j != i)
+                    {
+                        clause.push_back(SatSolver::pos(edge_id_list[j]));
+                    }
+                }
+                solver.add_clause(clause);
+            }
+        }
+        else if (query.label[node] > 0)
+        {
+            // exactly one edge
+            std::vector<int> clause;
+            for (size_t i = 0; i < edge_id_list.size(); i++)
+            {
+                clause.push_back(SatSolver::pos(edge_id_list[i]));
+                for (size_t j = i + 1; j < edge_id_list.size(); j++)
+                {
+                    solver.add_clause({SatSolver::neg(edge_id_list[i]), SatSolver::neg(edge_id_list[j])});
+                }
+            }
+            solver.add_clause(clause);
+        }
+        else
+        {
+            for (auto&& e : edge_id_list)
+            {
+                solver.add_clause({SatSolver::neg(e)});
+            }
+        }
+    }
+}
+
+bool SatBackend::solve(const OracleQuery& query)
+{
+    SatSolver solver;
+
+    // edge variables take the edge ids
+    for (size_t e = 0; e < edge_node_.size(); e++)
+    {
+        solver.new_var();
+    }
+
+    // labels 1..num_gate of each ancilla, at most one of them
+    const int num_gate = query.num_gate;
+    for (int node = 0; node < static_cast<int>(ancilla_.size()); node++)
+    {
+        if (!ancilla_[node])
+        {
+            continue;
+        }
+
+        label_var_[node] = solver.new_var();
+        for (int g = 1; g < num_gate; g++)
+        {
+            solver.new_var();
+        }
+        for (int g = 0; g < num_gate; g++)
+        {
+            for (int h = g + 1; h < num_gate; h++)
+            {
+                solver.add_clause({SatSolver::neg(label_var_[node] + g), SatSolver::neg(label_var_[node] + h)});
+            }
+        }
+    }
+
+    make_edge_clauses(solver, query, num_gate);
+
+    make_degree_clauses(solver, query);
+
+    return solver.solve();
+}
+
+}
@@ -0,0 +1,50 @@
+#ifndef T_SCHEDULING_SAT_BACKEND_HPP
+#define T_SCHEDULING_SAT_BACKEND_HPP
+
+#include <vector>
+
+#include "oracle_backend.hpp"
+#include "sat_solver.hpp"
+
+#include "../layout/layout.hpp"
+
+namespace tskd {
+
+/**
+ * in-tree backend of ParallelizationOracle
+ * each query is encoded into clauses and handed to a fresh SatSolver
+ * - an edge is a variable, a removed edge a unit clause
+ * - an ancilla has one variable per gate for its label, at most one of them true;
+ *   a component of selected edges without a qubit takes any label, so the
+ *   missing at-least-one clause keeps the encoding equisatisfiable
+ * - a selected edge forces the ancilla label of a qubit it reaches and carries
+ *   labels across ancillas; an edge between qubits of different gates is unusable
+ * - the edge counts of the nodes are direct clauses
+ */
+class SatBackend final : public OracleBackend
+{
+private:
+    std::vector<bool> ancilla_;                   // [node id]
+    std::vector<std::vector<int>> node_edge_;     // [node id] edge ids
+    std::vector<std::pair<int, int>> edge_node_;  // [edge id] end nodes
+
+    std::vector<int> label_var_; // [node id] first label variable of an ancilla, -1 otherwise
+
+    void make_edge_clauses(SatSolver& solver,
+                           const OracleQuery& query,
+                           int num_gate);
+
+    void make_degree_clauses(SatSolver& solver,
+                             const OracleQuery& query);
+
+public:
+    explicit SatBackend(const Layout& layout);
+
+    ~SatBackend() final = default;
+
+    bool solve(const OracleQuery& query) final;
+};
+
+}
+
+#endif //T_SCHEDULING_SAT_BACKEND_HPP
@@ -0,0 +1,326 @@
+#include <algorithm>
+
+#include "sat_solver.hpp"
+
+namespace tskd {
+
+int SatSolver::new_var()
+{
+    const int var = static_cast<int>(assign_.size());
+    assign_.push_back(-1);
+    level_.push_back(0);
+    reason_.push_back(-1);
+    phase_.push_back(false);
+    activity_.push_back(0.0);
+    seen_.push_back(false);
+    watch_list_.emplace_back();
+    watch_list_.emplace_back();
+
+    return var;
+}
+
+void SatSolver::enqueue(int lit,
+                        int reason)
+{
+    const int var = lit >> 1;
+    assign_[var] = static_cast<signed char>((lit & 1) ^ 1);
+    level_[var] = decision_level();
+    reason_[var] = reason;
+    trail_.push_back(lit);
+}
+
+void SatSolver::attach(int clause)
+{
+    const std::vector<int>& c = clause_list_[clause];
+    watch_list_[c[0]].push_back(clause);
+    watch_list_[c[1]].push_back(clause);
+}
+
+void SatSolver::add_clause(std::vector<int> lits)
+{
+    if (!ok_)
+    {
+        return;
+    }
+
+    /*
+     * drop duplicates and literals false at level 0; skip satisfied clauses
+     */
+    std::sort(lits.begin(), lits.end());
+    lits.erase(std::unique(lits.begin(), lits.end()), lits.end());
+    size_t j = 0;
+    for (size_t i = 0; i < lits.size(); i++)
+    {
+        if (value(lits[i]) == 1 || (i + 1 < lits.size() && lits[i + 1] == (lits[i] ^ 1)))
+        {
+            return;
+        }
+        if (value(lits[i]) == -1)
+        {
+            lits[j++] = lits[i];
+        }
+    }
+    lits.resize(j);
+
+    if (lits.empty())
+    {
+        ok_ = false;
+    }
+    else if (lits.size() == 1)
+    {
+        enqueue(lits[0], -1);
+        ok_ = (propagate() == -1);
+    }
+    else
+    {
+        clause_list_.push_back(std::move(lits));
+        attach(static_cast<int>(clause_list_.size()) - 1);
+    }
+}
+
+int SatSolver::propagate()
+{
+    while (head_ < trail_.size())
+    {
+        const int false_lit = trail_[head_++] ^ 1;
+        std::vector<int>& watch = watch_list_[false_lit];
+
+        size_t i = 0;
+        size_t j = 0;
+        while (i < watch.size())
+        {
+            const int clause = watch[i++];
+            std::vector<int>& c = clause_list_[clause];
+
+            // keep the false literal second
+            if (c[0] == false_lit)
+            {
+                std::swap(c[0], c[1]);
+            }
+            if (value(c[0]) == 1)
+            {
+                watch[j++] = clause;
+
+                continue;
+            }
+
+            // look for a new literal to watch
+            bool moved = false;
+            for (size_t k = 2; k < c.size(); k++)
+            {
+                if (value(c[k]) != 0)
+                {
+                    std::swap(c[1], c[k]);
+                    watch_list_[c[1]].push_back(clause);
+                    moved = true;
+
+                    break;
+                }
+            }
+            if (moved)
+            {
+                continue;
+            }
+
+            // unit or conflicting
+            watch[j++] = clause;
+            if (value(c[0]) == 0)
+            {
+                while (i < watch.size())
+                {
+                    watch[j++] = watch[i++];
+                }
+                watch.resize(j);
+                head_ = trail_.size();
+
+                return clause;
+            }
+            enqueue(c[0], clause);
+        }
+        watch.resize(j);
+    }
+
+    return -1;
+}
+
+int SatSolver::analyze(int conflict,
+                       std::vector<int>& learnt)
+{
+    /*
+     * resolve back along the trail to the first unique implication point
+     */
+    learnt.assign(1, -1);
+    int path = 0;
+    int lit = -1;
+    int index = static_cast<int>(trail_.size()) - 1;
+    do
+    {
+        const std::vector<int>& c = clause_list_[conflict];
+        for (size_t k = (lit == -1) ? 0 : 1; k < c.size(); k++)
+        {
+            const int var = c[k] >> 1;
+            if (!seen_[var] && level_[var] > 0)
+            {
+                bump(var);
+                seen_[var] = true;
+                if (level_[var] == decision_level())
+                {
+                    path++;
+                }
+                else
+                {
+                    learnt.push_back(c[k]);
+                }
+            }
+        }
+
+        while (!seen_[trail_[index] >> 1])
+        {
+            index--;
+        }
+        lit = trail_[index--];
+        conflict = reason_[lit >> 1];
+        seen_[lit >> 1] = false;
+        path--;
+    } while (path > 0);
+    learnt[0] = lit ^ 1;
+
+    // backjump to the highest level among the others, kept second for the watch
+    int back_level = 0;
+    for (size_t k = 1; k < learnt.size(); k++)
+    {
+        seen_[learnt[k] >> 1] = false;
+        if (level_[learnt[k] >> 1] > back_level)
+        {
+            back_level = level_[learnt[k] >> 1];
+            std::swap(learnt[1], learnt[k]);
+        }
+    }
+
+    return back_level;
+}
+
+void SatSolver::cancel_until(int level)
+{
+    if (decision_level() <= level)
+    {
+        return;
+    }
+
+    for (size_t i = trail_.size(); i > static_cast<size_t>(trail_lim_[level]); i--)
+    {
+        const int var = trail_[i - 1] >> 1;
+        phase_[var] = (assign_[var] == 1);
+        assign_[var] = -1;
+    }
+    trail_.resize(trail_lim_[level]);
+    trail_lim_.resize(level);
+    head_ = trail_.size();
+}
+
+void SatSolver::bump(int var)
+{
+    activity_[var] += var_inc_;
+    if (activity_[var] > 1e100)
+    {
+        for (auto&& a : activity_)
+        {
+            a *= 1e-100;
+        }
+        var_inc_ *= 1e-100;
+    }
+}
+
+int SatSolver::pick_branch() const
+{
+    int best = -1;
+    for (int var = 0; var < static_cast<int>(assign_.size()); var++)
+    {
+        if (assign_[var] < 0 && (best == -1 || activity_[var] > activity_[best]))
+        {
+            best = var;
+        }
+    }
+
+    return best;
+}
+
+long SatSolver::luby(long i)
+{
+    // i-th term (from 1) of 1, 1, 2, 1, 1, 2, 4, ...
+    long size = 1;
+    int seq = 0;
+    while (size < i + 1)
+    {
+        seq++;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != i)
+    {
+        size = (size - 1) >> 1;
+        seq--;
+        i = i % size;
+    }
+
+    return 1L << seq;
+}
+
+bool SatSolver::solve()
+{
+    constexpr long restart_unit = 64;
+
+    if (!ok_ || propagate() != -1)
+    {
+        return ok_ = false;
+    }
+
+    std::vector<int> learnt;
+    long num_restart = 0;
+    long conflict_limit = restart_unit * luby(num_restart);
+    long num_conflict = 0;
+    while (true)
+    {
+        const int conflict = propagate();
+        if (conflict != -1)
+        {
+            if (decision_level() == 0)
+            {
+                return ok_ = false;
+            }
+
+            const int back_level = analyze(conflict, learnt);
+            cancel_until(back_level);
+            if (learnt.size() == 1)
+            {
+                enqueue(learnt[0], -1);
+            }
+            else
+            {
+                clause_list_.push_back(learnt);
+                const int clause = static_cast<int>(clause_list_.size()) - 1;
+                attach(clause);
+                enqueue(learnt[0], clause);
+            }
+            var_inc_ /= 0.95;
+
+            if (++num_conflict >= conflict_limit)
+            {
+                cancel_until(0);
+                num_conflict = 0;
+                conflict_limit = restart_unit * luby(++num_restart);
+            }
+
+            continue;
+        }
+
+        const int var = pick_branch();
+        if (var == -1)
+        {
+            return true;
+        }
+        trail_lim_.push_back(static_cast<int>(trail_.size()));
+        enqueue(phase_[var] ? pos(var) : neg(var), -1);
+    }
+}
+
+}
@@ -0,0 +1,109 @@
+#ifndef T_SCHEDULING_SAT_SOLVER_HPP
+#define T_SCHEDULING_SAT_SOLVER_HPP
+
+#include <vector>
+#include <cstddef>
+
+namespace tskd {
+
+/**
+ * small CDCL solver for the clauses of SatBackend
+ * two watched literals, first-UIP learning, activity-based decisions with
+ * saved phases and Luby restarts; clauses are never deleted, as a query
+ * builds a fresh instance of a few thousand variables at most
+ * a literal is 2 * var for the variable and 2 * var + 1 for its negation
+ */
+class SatSolver
+{
+private:
+    std::vector<std::vector<int>> clause_list_;
+    std::vector<std::vector<int>> watch_list_; // [literal] clauses watching it
+
+    std::vector<signed char> assign_; // [var] 1: true, 0: false, -1: unassigned
+    std::vector<int> level_;          // [var]
+    std::vector<int> reason_;         // [var] clause that implied it, -1: decision or unit
+    std::vector<bool> phase_;         // [var] last value
+    std::vector<double> activity_;    // [var]
+    std::vector<bool> seen_;          // [var] scratch of analyze
+
+    std::vector<int> trail_;
+    std::vector<int> trail_lim_;      // [level] start of the level in the trail
+    std::size_t head_ = 0;            // next trail entry to propagate
+
+    double var_inc_ = 1.0;
+
+    bool ok_ = true; // false once the clauses are unsatisfiable at level 0
+
+    int value(int lit) const
+    {
+        const int a = assign_[lit >> 1];
+
+        return a < 0 ? -1 : a ^ (lit & 1);
+    }
+
+    int decision_level() const
+    {
+        return static_cast<int>(trail_lim_.size());
+    }
+
+    void enqueue(int lit,
+                 int reason);
+
+    void attach(int clause);
+
+    int propagate();
+
+    int analyze(int conflict,
+                std::vector<int>& learnt);
+
+    void cancel_until(int level);
+
+    void bump(int var);
+
+    int pick_branch() const;
+
+    static long luby(long i);
+
+public:
+    SatSolver() = default;
+
+    /**
+     * @return new variable
+     */
+    int new_var();
+
+    static int pos(int var)
+    {
+        return var << 1;
+    }
+
+    static int neg(int var)
+    {
+        return (var << 1) | 1;
+    }
+
+    /**
+     * add a clause, before solve()
+     * @param lits literals (reordered)
+     */
+    void add_clause(std::vector<int> lits);
+
+    /**
+     * @return true if the clauses are satisfiable
+     */
+    bool solve();
+
+    /**
+     * value of a variable in the model found by solve()
+     * @param var variable
+     * @return value
+     */
+    bool model(int var) const
+    {
+        return assign_[var] == 1;
+    }
+};
+
+}
+
+#endif //T_SCHEDULING_SAT_SOLVER_HPP
@@ -0,0 +1,261 @@
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+
+#include "z3_backend.hpp"
+
+namespace tskd {
+
+z3::expr Z3Backend::literal(const std::string& prefix,
+                            int index)
+{
+    return context_.bool_const((prefix + std::to_string(index)).c_str());
+}
+
+void Z3Backend::make_vars()
+{
+    if (encoding_ == OracleEncoding::kboolean)
+    {
+        // labels go up to the number of gates, at most one per qubit
+        int num_qubit = 0;
+        for (auto&& node : layout_.node_list())
+        {
+            num_qubit += (node->name() != "A");
+        }
+        label_width_ = 1;
+        while ((1 << label_width_) <= num_qubit)
+        {
+            label_width_++;
+        }
+    }
+
+    // make edge variables
+    for (size_t i = 0; i < layout_.edge_list().size(); i++)
+    {
+        const std::string name = std::to_string(new_variable());
+        edge_expr_array_.push_back(encoding_ == OracleEncoding::kboolean
+                                   ? context_.bool_const(name.c_str())
+                                   : context_.int_const(name.c_str()));
+    }
+
+    // make node id variables
+    for (size_t i = 0; i < layout_.node_list().size(); i++)
+    {
+        const std::string name = std::to_string(new_variable());
+        node_expr_array_.push_back(encoding_ == OracleEncoding::kboolean
+                                   ? context_.bv_const(name.c_str(), label_width_)
+                                   : context_.int_const(name.c_str()));
+    }
+}
+
+z3::expr Z3Backend::edge_used(int edge_id)
+{
+    z3::expr e = edge_expr_array_[edge_id];
+
+    return encoding_ == OracleEncoding::kboolean ? e : e == 1;
+}
+
+z3::expr Z3Backend::label_equal(int node_id,
+                                int k)
+{
+    z3::expr e = node_expr_array_[node_id];
+
+    return encoding_ == OracleEncoding::kboolean ? e == context_.bv_val(k, label_width_) : e == k;
+}
+
+z3::expr Z3Backend::label_in(int node_id,
+                             int lower,
+                             int upper)
+{
+    z3::expr e = node_expr_array_[node_id];
+    if (encoding_ == OracleEncoding::kboolean)
+    {
+        return z3::uge(e, context_.bv_val(lower, label_width_))
+               && z3::ule(e, context_.bv_val(std::min(upper, (1 << label_width_) - 1), label_width_));
+    }
+
+    return lower <= e && e <= upper;
+}
+
+void Z3Backend::make_base_constraint()
+{
+    make_range_constraint();
+
+    make_edge_constraints();
+
+    make_adj_nodes_constraint();
+}
+
+void Z3Backend::make_range_constraint()
+{
+    // the upper bound of the ancilla labels is assumed per query
+    for (auto&& node : layout_.node_list())
+    {
+        if (node->name() == "A")
+        {
+            solver_.add(label_in(node->id(), 1, layout_.node_list().size()));
+        }
+    }
+
+    if (encoding_ == OracleEncoding::kinteger)
+    {
+        for (auto&& edge : layout_.edge_list())
+        {
+            z3::expr e = edge_expr_array_[edge->id()];
+            solver_.add(0 <= e && e <= 1);
+        }
+    }
+
+    for (auto&& edge : layout_.edge_list())
+    {
+        z3::expr off = literal("off", edge->id());
+        solver_.add(z3::implies(off, !edge_used(edge->id())));
+        edge_off_.push_back(off);
+    }
+}
+
+void Z3Backend::make_edge_constraints()
+{
+    for (auto&& node : layout_.node_list())
+    {
+        /*
+         * degree of the node: an arithmetic sum, or cardinality constraints
+         * over the edge literals
+         */
+        const bool boolean = encoding_ == OracleEncoding::kboolean;
+        z3::expr_vector edge_array(context_);
+        z3::expr sum = context_.int_val(0);
+        for (auto&& edge : node->edge_list())
+        {
+            edge_array.push_back(edge_used(edge->id()));
+            if (!boolean)
+            {
+                sum = sum + edge_expr_array_[edge->id()];
+            }
+        }
+        z3::expr no_edge = boolean ? !z3::mk_or(edge_array) : sum == 0;
+
+        if (node->edge_list().size() < 2)
+        {
+            // not on the grid, left free as before; never assumed
+            one_edge_.push_back(context_.bool_val(true));
+            no_edge_.push_back(context_.bool_val(true));
+        }
+        else if (node->name() != "A")
+        {
+            // a qubit of the query has one edge, the others none
+            z3::expr one = literal("one", node->id());
+            z3::expr none = literal("none", node->id());
+            solver_.add(z3::implies(one, boolean ? z3::atleast(edge_array, 1) && z3::atmost(edge_array, 1)
+                                                 : sum == 1));
+            solver_.add(z3::implies(none, no_edge));
+            one_edge_.push_back(one);
+            no_edge_.push_back(none);
+        }
+        else
+        {
+            solver_.add(no_edge || (boolean ? z3::atleast(edge_array, 2) : sum >= 2));
+            one_edge_.push_back(context_.bool_val(true));
+            no_edge_.push_back(context_.bool_val(true));
+        }
+    }
+}
+
+void Z3Backend::make_adj_nodes_constraint()
+{
+    for (auto&& edge : layout_.edge_list())
+    {
+        z3::expr node_expr1 = node_expr_array_[edge->node_a()->id()];
+        z3::expr node_expr2 = node_expr_array_[edge->node_b()->id()];
+
+        solver_.add(z3::implies(edge_used(edge->id()), node_expr1 == node_expr2));
+    }
+}
+
+void Z3Backend::make_query_assumptions(const OracleQuery& query,
+                                       z3::expr_vector& assumptions)
+{
+    const int num_gate = query.num_gate;
+    auto bound = bound_.find(num_gate);
+    if (bound == bound_.end())
+    {
+        z3::expr lit = literal("bound", num_gate);
+        for (auto&& node : layout_.node_list())
+        {
+            if (node->name() == "A")
+            {
+                solver_.add(z3::implies(lit, label_in(node->id(), 1, num_gate)));
+            }
+        }
+        bound = bound_.emplace(num_gate, lit).first;
+    }
+    assumptions.push_back(bound->second);
+
+    for (auto&& node : layout_.node_list())
+    {
+        if (node->name() == "A")
+        {
+            continue;
+        }
+
+        const int id = query.label[node->id()];
+        if (node->edge_list().size() >= 2)
+        {
+            assumptions.push_back(id > 0 ? one_edge_[node->id()] : no_edge_[node->id()]);
+        }
+
+        const auto key = std::make_pair(node->id(), id);
+        auto label = label_.find(key);
+        if (label == label_.end())
+        {
+            z3::expr lit = literal("label" + std::to_string(id) + "_", node->id());
+            solver_.add(z3::implies(lit, label_equal(node->id(), id)));
+            label = label_.emplace(key, lit).first;
+        }
+        assumptions.push_back(label->second);
+    }
+
+    for (auto&& edge : layout_.edge_list())
+    {
+        if (query.edge_off[edge->id()])
+        {
+            assumptions.push_back(edge_off_[edge->id()]);
+        }
+    }
+}
+
+bool Z3Backend::solve(const OracleQuery& query)
+{
+    z3::expr_vector assumptions(context_);
+    make_query_assumptions(query, assumptions);
+
+    return solver_.check(assumptions) == z3::sat;
+}
+
+void Z3Backend::verification()
+{
+    z3::model m = solver_.get_model();
+
+    std::vector<int> node_var(m.size() + 1);
+    std::vector<int> edge_var(m.size() + 1);
+
+    // traversing the model
+    for (unsigned i = 0; i < m.size(); i++) {
+        z3::func_decl v = m[i];
+        assert(v.arity() == 0);
+        node_var[std::stoi(v.name().str())] = m.get_const_interp(v).get_numeral_int();
+        edge_var[std::stoi(v.name().str())] = m.get_const_interp(v).get_numeral_int();
+    }
+
+    for (int y = 0; y < layout_.height(); y++)
+    {
+        for (int x = 0; x < layout_.width(); x++)
+        {
+            int index = layout_.edge_list().size() + 1 + (y * layout_.width()) + x;
+            std::cout << node_var[index];
+        }
+        std::cout << std::endl;
+    }
+}
+
+}
@@ -0,0 +1,100 @@
+#ifndef T_SCHEDULING_Z3_BACKEND_HPP
+#define T_SCHEDULING_Z3_BACKEND_HPP
+
+#include <map>
+#include <vector>
+#include <string>
+
+#include "z3++.h"
+
+#include "oracle_backend.hpp"
+
+#include "../util/option.hpp"
+
+#include "../layout/layout.hpp"
+
+namespace tskd {
+
+/**
+ * Z3 backend of ParallelizationOracle
+ * the constraints of the layout are asserted once; a query only assumes
+ * literals that switch on its own constraints, so every clause stays
+ * asserted and lemmas learned in one query serve the next
+ */
+class Z3Backend final : public OracleBackend
+{
+private:
+    Layout layout_;
+
+    OracleEncoding encoding_;
+    unsigned label_width_ = 0; // bits of a bit-vector label
+
+    int var_count_ = 0;
+
+    z3::context context_;
+    z3::solver solver_;
+    z3::expr_vector edge_expr_array_;
+    z3::expr_vector node_expr_array_;
+
+    std::vector<z3::expr> one_edge_;  // [node id] literal: the qubit node has one edge
+    std::vector<z3::expr> no_edge_;   // [node id] literal: the qubit node has no edge
+    std::vector<z3::expr> edge_off_;  // [edge id] literal: the edge is unused
+    std::map<int, z3::expr> bound_;   // <k, literal: ancilla labels are at most k>
+    std::map<std::pair<int, int>, z3::expr> label_; // <<node id, k>, literal: the node is labelled k>
+
+    void make_vars();
+
+    z3::expr edge_used(int edge_id);
+
+    z3::expr label_equal(int node_id,
+                         int k);
+
+    z3::expr label_in(int node_id,
+                      int lower,
+                      int upper);
+
+    void make_base_constraint();
+
+    void make_range_constraint();
+
+    void make_edge_constraints();
+
+    void make_adj_nodes_constraint();
+
+    void make_query_assumptions(const OracleQuery& query,
+                                z3::expr_vector& assumptions);
+
+    z3::expr literal(const std::string& prefix,
+                     int index);
+
+    inline int new_variable()
+    {
+        var_count_ += 1;
+
+        return var_count_;
+    }
+
+    void verification();
+
+public:
+    Z3Backend(const Layout& layout,
+              OracleEncoding encoding)
+            : layout_(layout),
+              encoding_(encoding),
+              solver_(context_),
+              edge_expr_array_(context_),
+              node_expr_array_(context_)
+    {
+        make_vars();
+
+        make_base_constraint();
+    }
+
+    ~Z3Backend() final = default;
+
+    bool solve(const OracleQuery& query) final;
+};
+
+}
+
+#endif //T_SCHEDULING_Z3_BACKEND_HPP
@@ -106,6 +106,7 @@ void Simulator::calculate()
     constexpr int inc_time_step = 2;
     int current_time_step = 0;
     GateType previous_gate_type = GateType::kphase;
+    int previous_layer = -1;
 
     int num_t_gate = 0;
     int num_p_gate = 0;
@@ -155,6 +156,12 @@ void Simulator::calculate()
 
         if (gate.type() == "cnot" || gate.type() == "tof")
         {
+            // the rest of a layer runs in the step of its first gate
+            if (previous_gate_type == GateType::kcnot && gate.layer() != -1 && gate.layer() == previous_layer)
+            {
+                continue;
+            }
+            previous_layer = gate.layer();
             previous_gate_type = GateType::kcnot;
             update_buffer_capacity(inc_time_step, none);
             current_time_step += inc_time_step;
@@ -0,0 +1,201 @@
+#include "circuit_builder.hpp"
+
+#include "../decomposer/gaussian_decomposer.hpp"
+#include "../decomposer/parallel_decomposer.hpp"
+#include "../decomposer/pmh_decomposer.hpp"
+#include "../decomposer/steiner_decomposer.hpp"
+
+namespace tskd {
+
+template<typename Decomposer>
+bool CircuitBuilder<Decomposer>::init(const std::vector<util::xor_func>& in,
+                                      const std::vector<util::xor_func>& out)
+{
+    bool is_io_different = true;
+
+    bits_ = std::vector<util::xor_func>(qubit_num_);
+    preparation_ = std::vector<util::xor_func>(qubit_num_);
+    restoration_ = std::vector<util::xor_func>(qubit_num_);
+    identity_ = std::vector<util::xor_func>(qubit_num_);
+
+    for (int i = 0; i < qubit_num_; i++)
+    {
+        is_io_different &= (in[i] == out[i]);
+        preparation_[i] = util::xor_func(qubit_num_ + 1, 0);
+        restoration_[i] = util::xor_func(qubit_num_ + 1, 0);
+        identity_[i] = util::xor_func(qubit_num_ + 1, 0);
+        preparation_[i].set(i);
+        restoration_[i].set(i);
+        identity_[i].set(i);
+    }
+
+    return is_io_different;
+}
+
+template<typename Decomposer>
+void CircuitBuilder<Decomposer>::follow_func_map(const std::vector<int>& func_map,
+                                                 std::vector<util::xor_func>& restoration,
+                                                 std::unordered_map<int, int>& target_phase_map)
+{
+    /*
+     * procedure after remove swap gate
+     * change where the function is applied
+     */
+    std::vector<util::xor_func>& before_prep = workspace_.before;
+    before_prep = identity_;
+    util::compose(qubit_num_, before_prep, restoration, workspace_.scratch);
+    std::vector<util::xor_func>& after_prep = workspace_.after;
+    for (int i = 0; i < qubit_num_; i++)
+    {
+        after_prep[func_map[i]] = before_prep[i];
+    }
+    restoration = identity_;
+    util::compose(qubit_num_, restoration, after_prep, workspace_.scratch);
+
+    std::unordered_map<int, int> tmp;
+    for (auto&& map : target_phase_map)
+    {
+        const int target = map.first;
+        const int phase_index = map.second;
+        tmp.emplace(func_map[target], phase_index);
+    }
+    target_phase_map = tmp;
+}
+
+template<typename Decomposer>
+void CircuitBuilder<Decomposer>::apply_phase_gates(std::list<Gate>& gate_list,
+                                                   const std::unordered_map<int, int>& target_phase_map)
+{
+    for (auto&& tp : target_phase_map)
+    {
+        const int target = tp.first;
+        const int phase_exponent_index = tp.second;
+
+        if (phase_exponent_[phase_exponent_index].first <= 4)
+        {
+            if (phase_exponent_[phase_exponent_index].first / 4 == 1)
+            {
+                gate_list.emplace_back("Z", qubit_names_[target]);
+            }
+            if (phase_exponent_[phase_exponent_index].first / 2 == 1)
+            {
+                gate_list.emplace_back("P", qubit_names_[target]);
+            }
+            if (phase_exponent_[phase_exponent_index].first % 2 == 1)
+            {
+                gate_list.emplace_back("T", qubit_names_[target]);
+            }
+        }
+        else
+        {
+            if (phase_exponent_[phase_exponent_index].first == 5 || phase_exponent_[phase_exponent_index].first == 6)
+            {
+                gate_list.emplace_back("P*", qubit_names_[target]);
+            }
+            if (phase_exponent_[phase_exponent_index].first % 2 == 1)
+            {
+                gate_list.emplace_back("T*", qubit_names_[target]);
+            }
+        }
+    }
+}
+
+template<typename Decomposer>
+void CircuitBuilder<Decomposer>::unprepare(const std::vector<util::xor_func>& restoration)
+{
+    preparation_ = restoration;
+    // re-initialize
+    restoration_ = identity_;
+}
+
+template<typename Decomposer>
+void CircuitBuilder<Decomposer>::prepare_last_part(std::list<Gate>& gate_list,
+                                                   const std::vector<util::xor_func>& in,
+                                                   std::vector<util::xor_func>& out,
+                                                   MatrixReconstructor& sa)
+{
+    for (int i = 0; i < qubit_num_; i++)
+    {
+        bits_[i] = out[i];
+    }
+
+    std::unordered_map<int, int> bit_correspond_map;
+    for (int i = 0; i < static_cast<int>(out.size()); i++)
+    {
+        bit_correspond_map.emplace(i, i);
+    }
+
+    util::to_upper_echelon(qubit_num_, dimension_, bits_, &restoration_, std::vector<std::string>());
+    util::fix_basis(qubit_num_, dimension_, qubit_num_, in, bits_, &restoration_, std::vector<std::string>(),
+                    workspace_.pivots);
+
+    /*
+     * Re-construct binary matrix
+     */
+    if (option_.change_row_order())
+    {
+        restoration_ = sa.execute(preparation_, restoration_, bit_correspond_map);
+    }
+
+    // move bit place of out
+    std::vector<util::xor_func> tmp_out(out.size());
+    for (int i = 0; i < static_cast<int>(out.size()); i++)
+    {
+        tmp_out[i] = out[bit_correspond_map[i]];
+    }
+    out = tmp_out;
+
+    /*
+     * set preparation before decompose matrix
+     */
+    util::compose(qubit_num_, preparation_, restoration_, workspace_.scratch);
+
+    /*
+     * generate circuit from inverse matrix
+     */
+    std::vector<int>& func_map = workspace_.func_map;
+    workspace_.reset_func_map();
+    std::vector<util::xor_func>& rev_prep = workspace_.matrix;
+    rev_prep = identity_;
+    util::compose(qubit_num_, rev_prep, preparation_, workspace_.scratch);
+    gate_list.splice(gate_list.end(), decompose(rev_prep, func_map));
+
+    /*
+     * procedure after remove swap gate
+     * change where the function is applied
+     */
+    std::vector<util::xor_func> tmp(out.size());
+    for (int i = 0; i < static_cast<int>(out.size()); i++)
+    {
+        tmp[i] = out[func_map[i]];
+    }
+    out = tmp;
+}
+
+std::list<Gate> build_global_phase(int qubit_num,
+                                   int phase,
+                                   const std::vector<std::string>& qubit_names)
+{
+    std::list<Gate> acc;
+    int qubit = 0;
+
+    if (phase % 2 == 1)
+    {
+        acc.splice(acc.end(), util::compose_om(qubit, qubit_names));
+        qubit = (qubit + 1) % qubit_num;
+    }
+    for (int i = phase / 2; i > 0; i--)
+    {
+        acc.splice(acc.end(), util::compose_imaginary_unit(qubit, qubit_names));
+        qubit = (qubit + 1) % qubit_num;
+    }
+
+    return acc;
+}
+
+template class CircuitBuilder<GaussianDecomposer>;
+template class CircuitBuilder<ParallelDecomposer>;
+template class CircuitBuilder<PMHDecomposer>;
+template class CircuitBuilder<SteinerDecomposer>;
+
+}
@@ -0,0 +1,109 @@
+#ifndef T_SCHEDULING_CIRCUIT_BUILDER_HPP
+#define T_SCHEDULING_CIRCUIT_BUILDER_HPP
+
+#include <vector>
+#include <list>
+#include <string>
+#include <memory>
+#include <unordered_map>
+
+#include "../util/option.hpp"
+#include "../util/workspace.hpp"
+
+#include "../layout/layout.hpp"
+
+#include "../circuit/gate.hpp"
+
+#include "../matrix/matrix_reconstructor.hpp"
+
+namespace tskd {
+
+/**
+ * state and routines shared by the {CNOT, T} sub-circuit builders
+ * the decomposer is held by value, so its calls bind statically and inline
+ * @tparam Decomposer final subclass of MatrixDecomposer
+ */
+template<typename Decomposer>
+class CircuitBuilder
+{
+protected:
+    util::Option option_;
+
+    Layout layout_;
+
+    Decomposer decomposer_;
+
+    int qubit_num_;
+    int dimension_;
+
+    std::vector<std::string> qubit_names_;
+    std::vector<util::phase_exponent> phase_exponent_;
+
+    std::vector<util::xor_func> bits_;
+    std::vector<util::xor_func> preparation_;
+    std::vector<util::xor_func> restoration_;
+
+    std::vector<util::xor_func> identity_;
+
+    util::Workspace workspace_; // scratch reused across rounds
+
+    std::shared_ptr<ReorderCache> reorder_cache_; // row orders kept across calls, null when disabled
+
+    CircuitBuilder() = default;
+
+    CircuitBuilder(const util::Option& option,
+                   const Layout& layout,
+                   int qubit_num,
+                   int dimension,
+                   const std::vector<std::string>& qubit_names,
+                   const std::vector<util::phase_exponent>& phase_exponent)
+            : option_(option),
+              layout_(layout),
+              decomposer_(layout, qubit_num, 0, qubit_names),
+              qubit_num_(qubit_num),
+              dimension_(dimension),
+              qubit_names_(qubit_names),
+              phase_exponent_(phase_exponent),
+              workspace_(qubit_num, dimension),
+              reorder_cache_(option.sa_cache() ? std::make_shared<ReorderCache>() : nullptr) { }
+
+    bool init(const std::vector<util::xor_func>& in,
+              const std::vector<util::xor_func>& out);
+
+    /**
+     * decompose matrix into the gates of its inverse
+     * @param matrix parity matrix (destroyed)
+     * @param func_map [i] = wire the function of row i ends on
+     * @return gate list
+     */
+    std::list<Gate> decompose(std::vector<util::xor_func>& matrix,
+                              std::vector<int>& func_map)
+    {
+        std::list<Gate> ret = decomposer_.execute(matrix, func_map);
+        ret.reverse();
+
+        return ret;
+    }
+
+    void follow_func_map(const std::vector<int>& func_map,
+                         std::vector<util::xor_func>& restoration,
+                         std::unordered_map<int, int>& target_phase_map);
+
+    void apply_phase_gates(std::list<Gate>& gate_list,
+                           const std::unordered_map<int, int>& target_phase_map);
+
+    void unprepare(const std::vector<util::xor_func>& restoration);
+
+    void prepare_last_part(std::list<Gate>& gate_list,
+                           const std::vector<util::xor_func>& in,
+                           std::vector<util::xor_func>& out,
+                           MatrixReconstructor& sa);
+};
+
+std::list<Gate> build_global_phase(int qubit_num,
+                                   int phase,
+                                   const std::vector<std::string>& qubit_names);
+
+}
+
+#endif //T_SCHEDULING_CIRCUIT_BUILDER_HPP
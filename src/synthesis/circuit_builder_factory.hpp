@@ -0,0 +1,89 @@
+#ifndef T_SCHEDULING_CIRCUIT_BUILDER_FACTORY_HPP
+#define T_SCHEDULING_CIRCUIT_BUILDER_FACTORY_HPP
+
+#include <memory>
+
+#include "greedy_circuit_builder.hpp"
+#include "simple_circuit_builder.hpp"
+
+#include "../util/option.hpp"
+
+#include "../layout/layout.hpp"
+
+#include "../decomposer/gaussian_decomposer.hpp"
+#include "../decomposer/parallel_decomposer.hpp"
+#include "../decomposer/pmh_decomposer.hpp"
+#include "../decomposer/steiner_decomposer.hpp"
+
+namespace tskd {
+
+/**
+ * instantiate the circuit builder for the decomposer selected by the option
+ */
+class CircuitBuilderFactory
+{
+public:
+    CircuitBuilderFactory() = default;
+
+    template<typename Oracle>
+    std::shared_ptr<PhaseSetBuilder> create_greedy(const util::Option& option,
+                                                   const Layout& layout,
+                                                   const Oracle& oracle,
+                                                   int qubit_num,
+                                                   int dimension,
+                                                   const std::vector<std::string>& qubit_names,
+                                                   const std::vector<util::phase_exponent>& phase_exponent)
+    {
+        switch (option.dec_type())
+        {
+            case DecompositionType::kgauss:
+                return std::make_shared<GreedyCircuitBuilder<GaussianDecomposer, Oracle>>(
+                        option, layout, oracle, qubit_num, dimension, qubit_names, phase_exponent);
+            case DecompositionType::kparallel:
+                return std::make_shared<GreedyCircuitBuilder<ParallelDecomposer, Oracle>>(
+                        option, layout, oracle, qubit_num, dimension, qubit_names, phase_exponent);
+            case DecompositionType::kpmh:
+                return std::make_shared<GreedyCircuitBuilder<PMHDecomposer, Oracle>>(
+                        option, layout, oracle, qubit_num, dimension, qubit_names, phase_exponent);
+            case DecompositionType::ksteiner:
+                return std::make_shared<GreedyCircuitBuilder<SteinerDecomposer, Oracle>>(
+                        option, layout, oracle, qubit_num, dimension, qubit_names, phase_exponent);
+            default:
+                std::cerr << "invalid type of decomposer" << std::endl;
+
+                exit(1);
+        }
+    }
+
+    std::shared_ptr<PartitionBuilder> create_simple(const util::Option& option,
+                                                    const Layout& layout,
+                                                    int qubit_num,
+                                                    int dimension,
+                                                    const std::vector<std::string>& qubit_names,
+                                                    const std::vector<util::phase_exponent>& phase_exponent)
+    {
+        switch (option.dec_type())
+        {
+            case DecompositionType::kgauss:
+                return std::make_shared<SimpleCircuitBuilder<GaussianDecomposer>>(
+                        option, layout, qubit_num, dimension, qubit_names, phase_exponent);
+            case DecompositionType::kparallel:
+                return std::make_shared<SimpleCircuitBuilder<ParallelDecomposer>>(
+                        option, layout, qubit_num, dimension, qubit_names, phase_exponent);
+            case DecompositionType::kpmh:
+                return std::make_shared<SimpleCircuitBuilder<PMHDecomposer>>(
+                        option, layout, qubit_num, dimension, qubit_names, phase_exponent);
+            case DecompositionType::ksteiner:
+                return std::make_shared<SimpleCircuitBuilder<SteinerDecomposer>>(
+                        option, layout, qubit_num, dimension, qubit_names, phase_exponent);
+            default:
+                std::cerr << "invalid type of decomposer" << std::endl;
+
+                exit(1);
+        }
+    }
+};
+
+}
+
+#endif //T_SCHEDULING_CIRCUIT_BUILDER_FACTORY_HPP
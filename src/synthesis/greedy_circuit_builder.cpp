@@ -1,164 +1,252 @@
 #include <random>
 #include <chrono>
+#include <algorithm>
 
 #include "greedy_circuit_builder.hpp"
 
 #include "../tpar/partition.hpp"
+#include "../tpar/matroid.hpp"
 
 #include "../matrix/matrix_reconstructor.hpp"
 
+#include "../decomposer/gaussian_decomposer.hpp"
+#include "../decomposer/parallel_decomposer.hpp"
+#include "../decomposer/pmh_decomposer.hpp"
+#include "../decomposer/steiner_decomposer.hpp"
+
 namespace tskd {
 
-bool GreedyCircuitBuilder::init(const std::vector<util::xor_func>& in,
-                                const std::vector<util::xor_func>& out)
+template<typename Decomposer, typename Oracle>
+int GreedyCircuitBuilder<Decomposer, Oracle>::count_steps(const std::list<Gate>& gate_list)
 {
-    bool is_io_different = true;
-
-    bits_ = std::vector<util::xor_func>(qubit_num_);
-    preparation_ = std::vector<util::xor_func>(qubit_num_);
-    restoration_ = std::vector<util::xor_func>(qubit_num_);
-    identity_ = std::vector<util::xor_func>(qubit_num_);
-
-    for (int i = 0; i < qubit_num_; i++)
+    // the gates of a layer run in the step of its first gate, as in the Simulator
+    int num_step = 0;
+    int previous_layer = -1;
+    for (auto&& gate : gate_list)
     {
-        is_io_different &= (in[i] == out[i]);
-        preparation_[i] = util::xor_func(qubit_num_ + 1, 0);
-        restoration_[i] = util::xor_func(qubit_num_ + 1, 0);
-        identity_[i] = util::xor_func(qubit_num_ + 1, 0);
-        preparation_[i].set(i);
-        restoration_[i].set(i);
-        identity_[i].set(i);
+        if (gate.layer() == -1 || gate.layer() != previous_layer)
+        {
+            num_step++;
+        }
+        previous_layer = gate.layer();
     }
 
-    return is_io_different;
+    return num_step;
 }
 
-int GreedyCircuitBuilder::compute_time_step(const std::list<Gate>& gate_list)
+template<typename Decomposer, typename Oracle>
+int GreedyCircuitBuilder<Decomposer, Oracle>::compute_time_step(const std::list<Gate>& gate_list)
 {
-    return static_cast<int>(gate_list.size()) * 2;
+    return compute_time_step(count_steps(gate_list));
 }
 
-void GreedyCircuitBuilder::apply_phase_gates(std::list<Gate>& gate_list,
-                                             const std::unordered_map<int, int>& target_phase_map)
+template<typename Decomposer, typename Oracle>
+int GreedyCircuitBuilder<Decomposer, Oracle>::compute_time_step(int num_step)
 {
-    for (auto&& tp : target_phase_map)
-    {
-        const int target = tp.first;
-        const int phase_exponent_index = tp.second;
-
-        if (phase_exponent_[phase_exponent_index].first <= 4)
-        {
-            if (phase_exponent_[phase_exponent_index].first / 4 == 1)
-            {
-                gate_list.emplace_back("Z", qubit_names_[target]);
-            }
-            if (phase_exponent_[phase_exponent_index].first / 2 == 1)
-            {
-                gate_list.emplace_back("P", qubit_names_[target]);
-            }
-            if (phase_exponent_[phase_exponent_index].first % 2 == 1)
-            {
-                gate_list.emplace_back("T", qubit_names_[target]);
-            }
-        }
-        else
-        {
-            if (phase_exponent_[phase_exponent_index].first == 5 || phase_exponent_[phase_exponent_index].first == 6)
-            {
-                gate_list.emplace_back("P*", qubit_names_[target]);
-            }
-            if (phase_exponent_[phase_exponent_index].first % 2 == 1)
-            {
-                gate_list.emplace_back("T*", qubit_names_[target]);
-            }
-        }
-    }
+    return num_step * 2;
 }
 
-void GreedyCircuitBuilder::unprepare(const std::vector <util::xor_func>& restoration)
+template<typename Decomposer, typename Oracle>
+bool GreedyCircuitBuilder<Decomposer, Oracle>::is_independent(tpar::partition& sub_part,
+                                                              int index)
 {
-    preparation_ = std::move(restoration);
-    restoration_ = std::vector<util::xor_func>(qubit_num_);
-    // re-initialize
-    for (int i = 0; i < qubit_num_; i++)
+    if (sub_part.count(index))
     {
-        restoration_[i] = util::xor_func(qubit_num_ + 1, 0);
-        restoration_[i].set(i);
+        return oracle_(static_cast<int>(sub_part.size()), sub_part.rank(phase_exponent_, oracle_.length()));
     }
+
+    return tpar::fits_partition(sub_part, index, phase_exponent_, oracle_);
 }
 
-void GreedyCircuitBuilder::prepare_last_part(std::list<Gate>& gate_list,
-                                             const std::vector<util::xor_func>& in,
-                                             std::vector<util::xor_func>& out,
-                                             MatrixReconstructor& sa)
+template<typename Decomposer, typename Oracle>
+bool GreedyCircuitBuilder<Decomposer, Oracle>::evaluate_sub_part(const std::vector<util::xor_func>& in,
+                                                                 MatrixReconstructor& sa,
+                                                                 const tpar::partition& base,
+                                                                 int index,
+                                                                 util::Workspace& workspace,
+                                                                 SubCircuit& sub_circuit)
 {
-    for (int i = 0; i < qubit_num_; i++)
+    /**
+     * create bits matrix of base + {index} in ascending order
+     */
+    std::vector<util::xor_func>& tmp_bits = workspace.bits;
+    auto ti = base.begin();
+    bool inserted = base.count(index) > 0;
+    int counter = 0;
+    for (; ti != base.end() || !inserted; counter++)
     {
-        bits_[i] = out[i];
+        int member;
+        if (!inserted && (ti == base.end() || index < *ti))
+        {
+            member = index;
+            inserted = true;
+        }
+        else
+        {
+            member = *ti;
+            ti++;
+        }
+        tmp_bits[counter] = phase_exponent_[member].second;
     }
-
-    std::unordered_map<int, int> bit_correspond_map;
-    for (auto i = 0; i < out.size(); i++)
+    const int num_partition = counter;
+    for (; counter < qubit_num_; counter++)
     {
-        bit_correspond_map.emplace(i, i);
+        tmp_bits[counter].resize(dimension_ + 1);
+        tmp_bits[counter].reset();
     }
 
-    util::to_upper_echelon(qubit_num_, dimension_, bits_, &restoration_, std::vector<std::string>());
-    util::fix_basis(qubit_num_, dimension_, qubit_num_, in, bits_, &restoration_, std::vector<std::string>());
+    /**
+     * prepare preparation matrix
+     */
+    sub_circuit.restoration = restoration_;
+    util::to_upper_echelon(num_partition, dimension_, tmp_bits, &sub_circuit.restoration, std::vector<std::string>());
+    util::fix_basis(qubit_num_, dimension_, num_partition, in, tmp_bits, &sub_circuit.restoration,
+                    std::vector<std::string>(), workspace.pivots);
 
-    /*
-     * Re-construct binary matrix
+    /**
+     * change row order in the matrix
      */
     if (option_.change_row_order())
     {
-        restoration_ = sa.execute(preparation_, restoration_, bit_correspond_map);
+        sub_circuit.target_phase_map = std::unordered_map<int, int>();
+        ti = base.begin();
+        inserted = base.count(index) > 0;
+        for (counter = 0; counter < num_partition; counter++)
+        {
+            if (!inserted && (ti == base.end() || index < *ti))
+            {
+                sub_circuit.target_phase_map.emplace(counter, index);
+                inserted = true;
+            }
+            else
+            {
+                sub_circuit.target_phase_map.emplace(counter, *ti);
+                ti++;
+            }
+        }
+        sub_circuit.restoration = sa.execute(preparation_, sub_circuit.restoration, sub_circuit.target_phase_map);
     }
 
-    // move bit place of out
-    std::vector<util::xor_func> tmp_out(out.size());
-    for (auto i = 0; i < out.size(); i++)
+    /*
+     * the matrix to decompose is the inverse of (restoration^-1 preparation),
+     * i.e. the round's inverse preparation applied after the restoration
+     */
+    std::vector<util::xor_func>& rev_prep = workspace.matrix;
+    util::multiply(qubit_num_, sub_circuit.restoration, rev_preparation_, rev_prep);
+
+    const int buffer_upper_bound = std::max(1, (option_.num_buffer() / option_.num_distillation())) * option_.distillation_step();
+
+    int num_step = decomposer_.count_gates(rev_prep);
+    sub_circuit.decomposed = false;
+    if (num_step < 0)
     {
-        tmp_out[i] = out[bit_correspond_map[i]];
+        /*
+         * reject candidates that obviously exceed the buffer before decomposing them;
+         * the estimate destroys its input, so it works on a copy
+         */
+        if (num_partition != 1)
+        {
+            std::vector<util::xor_func>& estimate = workspace.scratch;
+            std::copy(rev_prep.begin(), rev_prep.end(), estimate.begin());
+            if (compute_time_step(decomposer_.estimate_gates(estimate)) > buffer_upper_bound)
+            {
+                return false;
+            }
+        }
+
+        sub_circuit.func_map.resize(qubit_num_);
+        for (int i = 0; i < qubit_num_; i++)
+        {
+            sub_circuit.func_map[i] = i;
+        }
+        sub_circuit.gate_list = decompose(rev_prep, sub_circuit.func_map);
+        sub_circuit.decomposed = true;
+        num_step = count_steps(sub_circuit.gate_list);
     }
-    out = tmp_out;
 
-    /*
-     * set preparation before decompose matrix
+    /**
+     * check time step
      */
-    std::vector<int> func_map(qubit_num_);
-    for (size_t i = 0; i < qubit_num_; i++)
+    return num_partition == 1 || compute_time_step(num_step) <= buffer_upper_bound;
+}
+
+template<typename Decomposer, typename Oracle>
+void GreedyCircuitBuilder<Decomposer, Oracle>::decompose_sub_part(const tpar::partition& sub_part,
+                                                                  SubCircuit& sub_circuit)
+{
+    if (!option_.change_row_order())
     {
-        func_map[i] = i;
+        sub_circuit.target_phase_map = std::unordered_map<int, int>();
+        int counter = 0;
+        for (int index : sub_part)
+        {
+            sub_circuit.target_phase_map.emplace(counter++, index);
+        }
     }
-    std::vector<util::xor_func> before_prep(identity_);
-    util::compose(qubit_num_, before_prep, restoration_);
-
-    util::compose(qubit_num_, preparation_, restoration_);
 
     /*
      * generate circuit from inverse matrix
      */
-    std::vector<util::xor_func> rev_prep(identity_);
-    util::compose(qubit_num_, rev_prep, preparation_);
-    std::list<Gate> ret = (*decomposer_).execute(rev_prep, func_map);
-    ret.reverse();
-    gate_list.splice(gate_list.end(), std::move(ret));
+    if (!sub_circuit.decomposed)
+    {
+        util::multiply(qubit_num_, sub_circuit.restoration, rev_preparation_, workspace_.matrix);
+        sub_circuit.func_map.resize(qubit_num_);
+        for (int i = 0; i < qubit_num_; i++)
+        {
+            sub_circuit.func_map[i] = i;
+        }
+        sub_circuit.gate_list = decompose(workspace_.matrix, sub_circuit.func_map);
+        sub_circuit.decomposed = true;
+    }
 
-    /*
-     * procedure after remove swap gate
-     * change where the function is applied
-     */
-    std::vector<util::xor_func> tmp(out.size());
-    for (auto i = 0; i < out.size(); i++)
+    follow_func_map(sub_circuit.func_map, sub_circuit.restoration, sub_circuit.target_phase_map);
+}
+
+template<typename Decomposer, typename Oracle>
+void GreedyCircuitBuilder<Decomposer, Oracle>::extend_sub_part(std::list<int>& candidate_list,
+                                                               const std::vector<util::xor_func>& in,
+                                                               MatrixReconstructor& sa,
+                                                               tpar::partition& result_sub_part,
+                                                               SubCircuit& result)
+{
+    // the row reconstructor shares one random engine, so it stays serial
+    if (pool_ != nullptr && !option_.change_row_order())
+    {
+        extend_sub_part_parallel(candidate_list, in, sa, result_sub_part, result);
+
+        return;
+    }
+
+    for (auto it = candidate_list.begin(); it != candidate_list.end();)
     {
-        tmp[i] = out[func_map[i]];
+        /*
+         * rank-one check against the maintained basis of the accepted set
+         */
+        if (!is_independent(result_sub_part, *it))
+        {
+            it++;
+            continue;
+        }
+
+        // the accepted candidate trades its buffers with the previous result
+        SubCircuit& candidate = candidate_.front();
+        if (evaluate_sub_part(in, sa, result_sub_part, *it, slot_workspace_.front(), candidate))
+        {
+            std::swap(result, candidate);
+            result_sub_part.insert(*it);
+            it = candidate_list.erase(it);
+        }
+        else
+        {
+            it++;
+        }
     }
-    out = tmp;
 }
 
-int GreedyCircuitBuilder::check_dimension(const Character& chr,
-                                          std::vector <util::xor_func>& wires,
-                                          int current_dimension)
+template<typename Decomposer, typename Oracle>
+int GreedyCircuitBuilder<Decomposer, Oracle>::check_dimension(const Character& chr,
+                                                              std::vector <util::xor_func>& wires,
+                                                              int current_dimension)
 {
     int new_dimension = 0;
     const int updated_dimension = util::compute_rank(chr.num_qubit(), chr.num_data_qubit() + chr.num_hadamard(), wires);
@@ -171,14 +259,63 @@ int GreedyCircuitBuilder::check_dimension(const Character& chr,
     return new_dimension;
 }
 
-std::list<Gate> GreedyCircuitBuilder::build(std::list<int>& index_list,
-                                            std::list<int>& carry_index_list,
-                                            std::vector<util::xor_func>& in,
-                                            std::vector<util::xor_func>& out)
+template<typename Decomposer, typename Oracle>
+void GreedyCircuitBuilder<Decomposer, Oracle>::extend_sub_part_parallel(std::list<int>& candidate_list,
+                                                                        const std::vector<util::xor_func>& in,
+                                                                        MatrixReconstructor& sa,
+                                                                        tpar::partition& result_sub_part,
+                                                                        SubCircuit& result)
 {
-    std::list<Gate> ret;
+    const size_t window = static_cast<size_t>(pool_->size());
+
+    for (auto it = candidate_list.begin(); it != candidate_list.end();)
+    {
+        /*
+         * take the next window of independent candidates against the committed set
+         */
+        window_list_.clear();
+        auto jt = it;
+        for (; jt != candidate_list.end() && window_list_.size() < window; jt++)
+        {
+            if (is_independent(result_sub_part, *jt))
+            {
+                window_list_.push_back(jt);
+            }
+        }
+
+        /*
+         * evaluate them speculatively, each in its own slot
+         */
+        accepted_.assign(window_list_.size(), 0);
+        pool_->run(static_cast<int>(window_list_.size()), [&](int k) {
+            accepted_[k] = evaluate_sub_part(in, sa, result_sub_part, *window_list_[k], slot_workspace_[k], candidate_[k]);
+        });
+
+        /*
+         * commit the first accepted candidate in list order, and re-validate
+         * the ones after it against the new set, as the serial loop would
+         */
+        it = jt;
+        for (size_t k = 0; k < window_list_.size(); k++)
+        {
+            if (accepted_[k])
+            {
+                std::swap(result, candidate_[k]);
+                result_sub_part.insert(*window_list_[k]);
+                it = candidate_list.erase(window_list_[k]);
+                break;
+            }
+        }
+    }
+}
 
-    std::vector<std::pair<int, int>> phase_target_list;
+template<typename Decomposer, typename Oracle>
+std::list<Gate> GreedyCircuitBuilder<Decomposer, Oracle>::build(std::list<int>& index_list,
+                                                                std::list<int>& carry_index_list,
+                                                                std::vector<util::xor_func>& in,
+                                                                std::vector<util::xor_func>& out)
+{
+    std::list<Gate> ret;
 
     if (init(in, out) && index_list.empty())
     {
@@ -190,279 +327,48 @@ std::list<Gate> GreedyCircuitBuilder::build(std::list<int>& index_list,
      */
     util::to_upper_echelon(qubit_num_, dimension_, in, &preparation_, std::vector<std::string>());
 
-    MatrixReconstructor sa(in, dimension_, qubit_num_);
+    MatrixReconstructor sa(in, dimension_, qubit_num_, option_, layout_, reorder_cache_);
 
     while (!index_list.empty())
     {
-        std::vector<util::xor_func> result_restoration(qubit_num_);
-        for (int i = 0; i < qubit_num_; i++)
-        {
-            result_restoration[i] = util::xor_func(qubit_num_ + 1, 0);
-            result_restoration[i].set(i);
-        }
-        std::list<Gate> result_gate_list;
-        std::set<int> result_sub_part;
-        std::list<int> delete_index_list;
-        std::unordered_map<int, int> result_target_phase_map;
+        SubCircuit& result = result_;
+        result.restoration = identity_;
+        result.target_phase_map.clear();
+        result.decomposed = false;
+        tpar::partition result_sub_part;
+
+        // every candidate of this round starts from the same preparation
+        rev_preparation_ = identity_;
+        util::compose(qubit_num_, rev_preparation_, preparation_, workspace_.scratch);
 
         /**
          * first build sub-circuit
          */
-        for (auto it = index_list.begin(); it != index_list.end();)
-        {
-            std::list<Gate> tmp_gate_list;
-            std::set<int> tmp_sub_part = result_sub_part;
-            tmp_sub_part.insert(*it);
-
-            std::vector<util::xor_func> tmp_bits(qubit_num_);
-            std::vector<util::xor_func> tmp_preparation = preparation_;
-            std::vector<util::xor_func> tmp_restoration = restoration_;
-
-            std::unordered_map<int, int> tmp_target_phase_map;
-
-            if (oracle_(phase_exponent_, tmp_sub_part))
-            {
-                /**
-                 * create bits matrix
-                 */
-                std::set<int>::iterator ti;
-                int counter = 0;
-                int t_num_in_par = 0;
-                for (ti = tmp_sub_part.begin(), counter = 0; counter < qubit_num_; counter++)
-                {
-                    if (counter < static_cast<int>(tmp_sub_part.size()))
-                    {
-                        tmp_bits[counter] = phase_exponent_[*ti].second;
-
-                        // count number of T gate
-                        if (phase_exponent_[*ti].first % 2 == 1) t_num_in_par++;
-
-                        tmp_target_phase_map.emplace(counter, *ti);
-                        ti++;
-                    }
-                    else
-                    {
-                        tmp_bits[counter] = util::xor_func(dimension_ + 1, 0);
-                    }
-                }
-
-                /**
-                 * prepare preparation matrix
-                 */
-                const int num_partition = static_cast<int>(tmp_sub_part.size());
-                util::to_upper_echelon(num_partition, dimension_, tmp_bits, &tmp_restoration, std::vector<std::string>());
-                util::fix_basis(qubit_num_, dimension_, num_partition, in, tmp_bits, &tmp_restoration,
-                               std::vector<std::string>());
-
-                /**
-                 * change row order in the matrix
-                 */
-                if (option_.change_row_order())
-                {
-                    tmp_restoration = sa.execute(tmp_preparation, tmp_restoration, tmp_target_phase_map);
-                }
-
-                /*
-                 * set preparation before decompose matrix
-                 */
-                std::vector<int> func_map(qubit_num_);
-                for (size_t i = 0; i < qubit_num_; i++)
-                {
-                    func_map[i] = i;
-                }
-                std::vector<util::xor_func> before_prep(identity_);
-                util::compose(qubit_num_, before_prep, tmp_restoration);
-
-                util::compose(qubit_num_, tmp_preparation, tmp_restoration);
-
-                /*
-                 * generate circuit from inverse matrix
-                 */
-                std::vector<util::xor_func> tmp_rev_prep(identity_);
-                util::compose(qubit_num_, tmp_rev_prep, tmp_preparation);
-                std::list<Gate> tmp_ret = (*decomposer_).execute(tmp_rev_prep, func_map);
-                tmp_ret.reverse();
-                tmp_gate_list.splice(tmp_gate_list.end(), std::move(tmp_ret));
-
-                /*
-                 * procedure after remove swap gate
-                 * change where the function is applied
-                 */
-                std::vector<util::xor_func> after_prep(qubit_num_);
-                for (size_t i = 0; i < qubit_num_; i++)
-                {
-                    after_prep[func_map[i]] = before_prep[i];
-                }
-                std::vector<util::xor_func> after_rest(identity_);
-                util::compose(qubit_num_, after_rest, after_prep);
-                tmp_restoration = after_rest;
-
-                std::unordered_map<int, int> tmp;
-                for (auto&& map : tmp_target_phase_map)
-                {
-                    const int target = map.first;
-                    const int phase_index = map.second;
-                    tmp.emplace(func_map[target], phase_index);
-                }
-                tmp_target_phase_map = tmp;
-
-                /**
-                 * check time step
-                 */
-                const int buffer_upper_bound = std::max(1, (option_.num_buffer() / option_.num_distillation())) * option_.distillation_step();
-                if (tmp_sub_part.size() == 1 || compute_time_step(tmp_gate_list) <= buffer_upper_bound)
-                {
-                    result_restoration = tmp_restoration;
-                    result_sub_part = tmp_sub_part;
-                    result_gate_list = tmp_gate_list;
-                    result_target_phase_map = tmp_target_phase_map;
-                    it = index_list.erase(it);
-                }
-                else
-                {
-                    it++;
-                }
-            }
-            else
-            {
-                it++;
-            }
-        }
+        extend_sub_part(index_list, in, sa, result_sub_part, result);
 
         /**
          * second build sub-circuit
          */
-        for (auto it = carry_index_list.begin(); it != carry_index_list.end();)
-        {
-            std::list<Gate> tmp_gate_list;
-            std::set<int> tmp_sub_part = result_sub_part;
-            tmp_sub_part.insert(*it);
-
-            std::vector<util::xor_func> tmp_bits(qubit_num_);
-            std::vector<util::xor_func> tmp_preparation = preparation_;
-            std::vector<util::xor_func> tmp_restoration = restoration_;
+        extend_sub_part(carry_index_list, in, sa, result_sub_part, result);
 
-            std::unordered_map<int, int> tmp_target_phase_map;
-
-            if (oracle_(phase_exponent_, tmp_sub_part))
-            {
-                /**
-                 * create bits matrix
-                 */
-                std::set<int>::iterator ti;
-                int counter = 0;
-                int t_num_in_par = 0;
-                for (ti = tmp_sub_part.begin(), counter = 0; counter < qubit_num_; counter++)
-                {
-                    if (counter < static_cast<int>(tmp_sub_part.size()))
-                    {
-                        tmp_bits[counter] = phase_exponent_[*ti].second;
-
-                        // count number of T gate
-                        if (phase_exponent_[*ti].first % 2 == 1) t_num_in_par++;
-
-                        tmp_target_phase_map.emplace(counter, *ti);
-                        ti++;
-                    }
-                    else
-                    {
-                        tmp_bits[counter] = util::xor_func(dimension_ + 1, 0);
-                    }
-                }
-
-                /**
-                 * prepare preparation matrix
-                 */
-                const int num_partition = static_cast<int>(tmp_sub_part.size());
-                util::to_upper_echelon(num_partition, dimension_, tmp_bits, &tmp_restoration, std::vector<std::string>());
-                util::fix_basis(qubit_num_, dimension_, num_partition, in, tmp_bits, &tmp_restoration,
-                               std::vector<std::string>());
-
-                /**
-                 * change row order in the matrix
-                 */
-                if (option_.change_row_order())
-                {
-                    tmp_restoration = sa.execute(tmp_preparation, tmp_restoration, tmp_target_phase_map);
-                }
-
-                /*
-                 * set preparation before decompose matrix
-                 */
-                std::vector<int> func_map(qubit_num_);
-                for (size_t i = 0; i < qubit_num_; i++)
-                {
-                    func_map[i] = i;
-                }
-                std::vector<util::xor_func> before_prep(identity_);
-                util::compose(qubit_num_, before_prep, tmp_restoration);
-                util::compose(qubit_num_, tmp_preparation, tmp_restoration);
-
-                /*
-                 * generate circuit from inverse matrix
-                 */
-                std::vector<util::xor_func> tmp_rev_prep(identity_);
-                util::compose(qubit_num_, tmp_rev_prep, tmp_preparation);
-                std::list<Gate> tmp_ret = (*decomposer_).execute(tmp_rev_prep, func_map);
-                tmp_ret.reverse();
-                tmp_gate_list.splice(tmp_gate_list.end(), std::move(tmp_ret));
-
-                /*
-                 * procedure after remove swap gate
-                 * change where the function is applied
-                 */
-                std::vector<util::xor_func> after_prep(qubit_num_);
-                for (size_t i = 0; i < qubit_num_; i++)
-                {
-                    after_prep[func_map[i]] = before_prep[i];
-                }
-                std::vector<util::xor_func> after_rest(identity_);
-                util::compose(qubit_num_, after_rest, after_prep);
-                tmp_restoration = after_rest;
-
-                std::unordered_map<int, int> tmp;
-                for (auto&& map : tmp_target_phase_map)
-                {
-                    const int target = map.first;
-                    const int phase_index = map.second;
-                    tmp.emplace(func_map[target], phase_index);
-                }
-                tmp_target_phase_map = tmp;
-
-                /**
-                 * check time step
-                 */
-                const int buffer_upper_bound = std::max(1, (option_.num_buffer() / option_.num_distillation())) * option_.distillation_step();
-                if (tmp_sub_part.size() == 1 || compute_time_step(tmp_gate_list) <= buffer_upper_bound)
-                {
-                    result_restoration = tmp_restoration;
-                    result_sub_part = tmp_sub_part;
-                    result_gate_list = tmp_gate_list;
-                    result_target_phase_map = tmp_target_phase_map;
-                    it = carry_index_list.erase(it);
-                }
-                else
-                {
-                    it++;
-                }
-            }
-            else
-            {
-                it++;
-            }
+        /*
+         * Decompose only the accepted sub-circuit
+         */
+        if (!result_sub_part.empty())
+        {
+            decompose_sub_part(result_sub_part, result);
         }
-
-        ret.splice(ret.end(), result_gate_list);
+        ret.splice(ret.end(), result.gate_list);
 
         /*
          * Apply the phase gates
          */
-        apply_phase_gates(ret, result_target_phase_map);
+        apply_phase_gates(ret, result.target_phase_map);
 
         /*
          * Unprepare the bits
          */
-        unprepare(result_restoration);
+        unprepare(result.restoration);
     }
 
     /*
@@ -473,26 +379,9 @@ std::list<Gate> GreedyCircuitBuilder::build(std::list<int>& index_list,
     return ret;
 }
 
+template class GreedyCircuitBuilder<GaussianDecomposer, util::IndependentOracle>;
+template class GreedyCircuitBuilder<ParallelDecomposer, util::IndependentOracle>;
+template class GreedyCircuitBuilder<PMHDecomposer, util::IndependentOracle>;
+template class GreedyCircuitBuilder<SteinerDecomposer, util::IndependentOracle>;
 
-std::list<Gate> GreedyCircuitBuilder::build_global_phase(int qubit_num,
-                                                       int phase,
-                                                       const std::vector<std::string>& qubit_names)
-{
-    std::list<Gate> acc;
-    int qubit = 0;
-
-    if (phase % 2 == 1)
-    {
-        acc.splice(acc.end(), util::compose_om(qubit, qubit_names));
-        qubit = (qubit + 1) % qubit_num;
-    }
-    for (int i = phase / 2; i > 0; i--)
-    {
-        acc.splice(acc.end(), util::compose_imaginary_unit(qubit, qubit_names));
-        qubit = (qubit + 1) % qubit_num;
-    }
-
-    return acc;
-}
-
-}
+}
\ No newline at end of file
@@ -6,7 +6,11 @@
 #include <string>
 #include <memory>
 
+#include "circuit_builder.hpp"
+
 #include "../util/option.hpp"
+#include "../util/thread_pool.hpp"
+#include "../util/workspace.hpp"
 
 #include "../layout/layout.hpp"
 
@@ -17,104 +21,156 @@
 
 #include "../tpar/partition.hpp"
 
-#include "../decomposer/matrix_decomposer.hpp"
-#include "../decomposer/gaussian_decomposer.hpp"
-#include "../decomposer/parallel_decomposer.hpp"
-
 #include "../matrix/matrix_reconstructor.hpp"
 
 
 namespace tskd {
 
+/**
+ * interface of the builders that pick the phase exponents of each round greedily
+ */
+class PhaseSetBuilder
+{
+public:
+    virtual ~PhaseSetBuilder() = default;
+
+    virtual std::list<Gate> build(std::list<int>& index_list,
+                                  std::list<int>& carry_index_list,
+                                  std::vector <util::xor_func>& in,
+                                  std::vector <util::xor_func>& out) = 0;
+
+    virtual int check_dimension(const Character& chr,
+                                std::vector <util::xor_func>& wires,
+                                int current_dimension) = 0;
+};
+
 /**
  * T-scheduling
  * this class build {CNOT, T} sub-circuit for given partitions greedy
+ * @tparam Decomposer final subclass of MatrixDecomposer
+ * @tparam Oracle independence oracle of the partitions
  */
-class GreedyCircuitBuilder
+template<typename Decomposer, typename Oracle>
+class GreedyCircuitBuilder final : public PhaseSetBuilder,
+                                   private CircuitBuilder<Decomposer>
 {
 private:
-    util::Option option_;
+    using Base = CircuitBuilder<Decomposer>;
+
+    using Base::option_;
+    using Base::layout_;
+    using Base::decomposer_;
+    using Base::qubit_num_;
+    using Base::dimension_;
+    using Base::phase_exponent_;
+    using Base::preparation_;
+    using Base::restoration_;
+    using Base::identity_;
+    using Base::workspace_;
+    using Base::reorder_cache_;
+
+    using Base::init;
+    using Base::decompose;
+    using Base::follow_func_map;
+    using Base::apply_phase_gates;
+    using Base::unprepare;
+    using Base::prepare_last_part;
+
+    /**
+     * candidate sub-circuit for a set of phase exponents
+     */
+    struct SubCircuit
+    {
+        std::vector<util::xor_func> restoration;
+        std::unordered_map<int, int> target_phase_map; // filled by evaluation only when the rows are reordered
 
-    Layout layout_;
+        // filled by evaluation only when the decomposer cannot count gates
+        bool decomposed = false;
+        std::list<Gate> gate_list;
+        std::vector<int> func_map;
+    };
 
-    std::shared_ptr <MatrixDecomposer> decomposer_;
+    Oracle oracle_;
 
-    util::IndependentOracle oracle_;
+    std::shared_ptr<util::ThreadPool> pool_; // evaluates candidates speculatively, null when serial
 
-    int qubit_num_;
-    int dimension_;
+    std::vector<util::xor_func> rev_preparation_; // inverse of preparation_, fixed during a round
 
-    std::vector<std::string> qubit_names_;
-    std::vector<util::phase_exponent> phase_exponent_;
+    /*
+     * scratch reused across candidates and rounds, one slot per pool thread
+     */
+    std::vector<util::Workspace> slot_workspace_;
+    std::vector<SubCircuit> candidate_;
+    SubCircuit result_;
+    std::vector<std::list<int>::iterator> window_list_;
+    std::vector<char> accepted_;
 
-    std::vector<util::xor_func> bits_;
-    std::vector<util::xor_func> preparation_;
-    std::vector<util::xor_func> restoration_;
+    /**
+     * @param gate_list gate list
+     * @return steps of the gates, a layer of multi-target cnots counting once
+     */
+    static int count_steps(const std::list<Gate>& gate_list);
 
-    std::vector<util::xor_func> identity_;
+    int compute_time_step(const std::list<Gate>& gate_list);
 
-    bool init(const std::vector <util::xor_func>& in,
-              const std::vector <util::xor_func>& out);
+    int compute_time_step(int num_step);
 
-    int compute_time_step(const std::list<Gate>& gate_list);
+    bool is_independent(tpar::partition& sub_part,
+                        int index);
 
-    void apply_phase_gates(std::list<Gate>& gate_list,
-                           const std::unordered_map<int, int>& target_phase_map);
+    bool evaluate_sub_part(const std::vector<util::xor_func>& in,
+                           MatrixReconstructor& sa,
+                           const tpar::partition& base,
+                           int index,
+                           util::Workspace& workspace,
+                           SubCircuit& sub_circuit);
 
-    void unprepare(const std::vector <util::xor_func>& restoration);
+    void decompose_sub_part(const tpar::partition& sub_part,
+                            SubCircuit& sub_circuit);
 
-    void prepare_last_part(std::list<Gate>& gate_list,
-                           const std::vector<util::xor_func>& in,
-                           std::vector<util::xor_func>& out,
-                           MatrixReconstructor& sa);
+    void extend_sub_part_parallel(std::list<int>& candidate_list,
+                                  const std::vector<util::xor_func>& in,
+                                  MatrixReconstructor& sa,
+                                  tpar::partition& result_sub_part,
+                                  SubCircuit& result);
 
-public:
-    GreedyCircuitBuilder() = default;
+    void extend_sub_part(std::list<int>& candidate_list,
+                         const std::vector<util::xor_func>& in,
+                         MatrixReconstructor& sa,
+                         tpar::partition& result_sub_part,
+                         SubCircuit& result);
 
-    template<typename oracle_type>
+public:
     GreedyCircuitBuilder(const util::Option& option,
                          const Layout& layout,
-                         const oracle_type& oracle,
+                         const Oracle& oracle,
                          int qubit_num,
                          int dimension,
                          const std::vector <std::string>& qubit_names,
                          const std::vector <util::phase_exponent>& phase_exponent)
-            : option_(option),
-              layout_(layout),
-              oracle_(oracle),
-              qubit_num_(qubit_num),
-              dimension_(dimension),
-              qubit_names_(qubit_names),
-              phase_exponent_(phase_exponent)
+            : Base(option, layout, qubit_num, dimension, qubit_names, phase_exponent),
+              oracle_(oracle)
     {
-        if (option.dec_type() == DecompositionType::kgauss)
+        if (option.num_thread() > 1)
         {
-            decomposer_ = std::make_shared<GaussianDecomposer>(layout, qubit_num, 0, qubit_names);
+            pool_ = std::make_shared<util::ThreadPool>(option.num_thread());
         }
-        else if (option.dec_type() == DecompositionType::kparallel)
-        {
-            decomposer_ = std::make_shared<ParallelDecomposer>(layout, qubit_num, 0, qubit_names);
-        }
-        else
-        {
-            std::cerr << "invalid type of decomposer" << std::endl;
 
-            exit(1);
-        }
+        const int num_slot = pool_ != nullptr ? pool_->size() : 1;
+        slot_workspace_.assign(num_slot, util::Workspace(qubit_num, dimension));
+        candidate_.resize(num_slot);
+        window_list_.reserve(num_slot);
+        accepted_.reserve(num_slot);
     }
 
     std::list<Gate> build(std::list<int>& index_list,
                           std::list<int>& carry_index_list,
                           std::vector <util::xor_func>& in,
-                          std::vector <util::xor_func>& out);
-
-    static std::list<Gate> build_global_phase(int qubit_num,
-                                              int phase,
-                                              const std::vector <std::string>& qubit_names);
+                          std::vector <util::xor_func>& out) final;
 
     int check_dimension(const Character& chr,
                         std::vector <util::xor_func>& wires,
-                        int current_dimension);
+                        int current_dimension) final;
 };
 
 }
@@ -6,6 +6,8 @@
 #include <string>
 #include <memory>
 
+#include "circuit_builder.hpp"
+
 #include "../util/option.hpp"
 
 #include "../layout/layout.hpp"
@@ -15,40 +17,53 @@
 
 #include "../tpar/partition.hpp"
 
-#include "../decomposer/matrix_decomposer.hpp"
-#include "../decomposer/gaussian_decomposer.hpp"
-#include "../decomposer/parallel_decomposer.hpp"
-
 #include "../matrix/matrix_reconstructor.hpp"
 
 namespace tskd {
 
 /**
- * this class build {CNOT, T} sub-circuit for given partitions
+ * interface of the builders that take a fixed partitioning
  */
-class SimpleCircuitBuilder
+class PartitionBuilder
 {
-private:
-    util::Option option_;
-
-    Layout layout_;
-
-    std::shared_ptr<MatrixDecomposer> decomposer_;
-
-    int qubit_num_;
-    int dimension_;
-
-    std::vector<std::string> qubit_names_;
-    std::vector<util::phase_exponent> phase_exponent_;
-
-    std::vector<util::xor_func> bits_;
-    std::vector<util::xor_func> preparation_;
-    std::vector<util::xor_func> restoration_;
+public:
+    virtual ~PartitionBuilder() = default;
 
-    std::vector<util::xor_func> identity_;
+    virtual std::list<Gate> build(const tpar::partitioning& partition,
+                                  std::vector<util::xor_func>& in,
+                                  std::vector<util::xor_func>& out,
+                                  const std::vector<int>& bit_map) = 0;
+};
 
-    bool init(const std::vector<util::xor_func>& in,
-              const std::vector<util::xor_func>& out);
+/**
+ * this class build {CNOT, T} sub-circuit for given partitions
+ * @tparam Decomposer final subclass of MatrixDecomposer
+ */
+template<typename Decomposer>
+class SimpleCircuitBuilder final : public PartitionBuilder,
+                                   private CircuitBuilder<Decomposer>
+{
+private:
+    using Base = CircuitBuilder<Decomposer>;
+
+    using Base::option_;
+    using Base::layout_;
+    using Base::qubit_num_;
+    using Base::dimension_;
+    using Base::phase_exponent_;
+    using Base::bits_;
+    using Base::preparation_;
+    using Base::restoration_;
+    using Base::identity_;
+    using Base::workspace_;
+    using Base::reorder_cache_;
+
+    using Base::init;
+    using Base::decompose;
+    using Base::follow_func_map;
+    using Base::apply_phase_gates;
+    using Base::unprepare;
+    using Base::prepare_last_part;
 
     void init_bits(const std::set<int>& phase_exponent_index_set,
                    std::unordered_map<int, int>& target_phase_map,
@@ -61,57 +76,19 @@ private:
                  MatrixReconstructor& sa,
                  const std::vector<int>& bit_map);
 
-    void apply_phase_gates(std::list<Gate>& gate_list,
-                           const std::unordered_map<int, int>& target_phase_map);
-
-    void unprepare();
-
-    void prepare_last_part(std::list<Gate>& gate_list,
-                           const std::vector<util::xor_func>& in,
-                           std::vector<util::xor_func>& out,
-                           MatrixReconstructor& sa,
-                           const std::vector<int>& bit_map);
-
 public:
-    SimpleCircuitBuilder() = default;
-
     SimpleCircuitBuilder(const util::Option& option,
                          const Layout& layout,
                          int qubit_num,
                          int dimension,
                          const std::vector<std::string>& qubit_names,
                          const std::vector<util::phase_exponent>& phase_exponent)
-        : option_(option),
-          layout_(layout),
-          qubit_num_(qubit_num),
-          dimension_(dimension),
-          qubit_names_(qubit_names),
-          phase_exponent_(phase_exponent)
-    {
-        if (option.dec_type() == DecompositionType::kgauss)
-        {
-            decomposer_ = std::make_shared<GaussianDecomposer>(layout, qubit_num, 0, qubit_names);
-        }
-        else if (option.dec_type() == DecompositionType::kparallel)
-        {
-            decomposer_ = std::make_shared<ParallelDecomposer>(layout, qubit_num, 0, qubit_names);
-        }
-        else
-        {
-            std::cerr << "invalid type of decomposer" << std::endl;
-
-            exit(1);
-        }
-    }
+        : Base(option, layout, qubit_num, dimension, qubit_names, phase_exponent) { }
 
     std::list<Gate> build(const tpar::partitioning& partition,
                           std::vector<util::xor_func>& in,
                           std::vector<util::xor_func>& out,
-                          const std::vector<int>& bit_map);
-
-    static std::list<Gate> build_global_phase(int qubit_num,
-                                              int phase,
-                                              const std::vector<std::string>& qubit_names);
+                          const std::vector<int>& bit_map) final;
 };
 
 }
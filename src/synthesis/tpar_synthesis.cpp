@@ -54,12 +54,20 @@ void TparSynthesis::init(const Character& chr)
 
 void TparSynthesis::create_partition()
 {
+    std::list<int> ready;
     for (auto it = remaining_.begin(); it != remaining_.end();)
     {
         util::xor_func tmp = (~mask_) & (chr_.phase_exponents()[*it].second);
         if (tmp.none())
         {
-            tpar::add_to_partition(floats_, *it, chr_.phase_exponents(), oracle_);
+            if (option_.bulk_partition())
+            {
+                ready.push_back(*it);
+            }
+            else
+            {
+                tpar::add_to_partition(floats_, *it, chr_.phase_exponents(), oracle_);
+            }
             it = remaining_.erase(it);
         }
         else
@@ -67,18 +75,22 @@ void TparSynthesis::create_partition()
             it++;
         }
     }
+
+    if (!ready.empty())
+    {
+        tpar::add_to_partition_bulk(floats_, ready, chr_.phase_exponents(), oracle_);
+    }
 }
 
 void TparSynthesis::determine_apply_partition(Character::Hadamard& hadamard)
 {
-    // TODO: freeze_partisionsの第二引数のconst化
     frozen_ = tpar::freeze_partitions(floats_, hadamard.in_);
 }
 
 void TparSynthesis::construct_subcircuit(Character::Hadamard& hadamard)
 {
     std::vector<util::xor_func> original_hadamard_outputs = hadamard.input_wires_parity_;
-    circuit_.add_gate_list(builder_.build(frozen_, wires_, hadamard.input_wires_parity_, bit_map_));
+    circuit_.add_gate_list(builder_->build(frozen_, wires_, hadamard.input_wires_parity_, bit_map_));
     update_bit_map(original_hadamard_outputs, hadamard.input_wires_parity_);
 
     for (int i = 0; i < chr_.num_qubit(); i++)
@@ -104,7 +116,7 @@ int TparSynthesis::check_dimension(int current_dimension)
     {
         new_dimension = updated_dimension;
         oracle_.set_dim(new_dimension);
-        tpar::repartition(floats_, chr_.phase_exponents(), oracle_);
+        tpar::repartition_incremental(floats_, chr_.phase_exponents(), oracle_);
     }
 
     return new_dimension;
@@ -113,12 +125,12 @@ int TparSynthesis::check_dimension(int current_dimension)
 void TparSynthesis::construct_final_subcircuit()
 {
     std::vector<util::xor_func> outputs = chr_.outputs();
-    circuit_.add_gate_list(builder_.build(floats_, wires_, outputs, bit_map_));
+    circuit_.add_gate_list(builder_->build(floats_, wires_, outputs, bit_map_));
 
     /*
      * Add the global phase
      */
-    circuit_.add_gate_list(builder_.build_global_phase(chr_.num_qubit(), global_phase_, chr_.qubit_names()));
+    circuit_.add_gate_list(build_global_phase(chr_.num_qubit(), global_phase_, chr_.qubit_names()));
 }
 
 
@@ -4,6 +4,7 @@
 #include "synthesis.hpp"
 
 #include "simple_circuit_builder.hpp"
+#include "circuit_builder_factory.hpp"
 
 #include "../character/character.hpp"
 
@@ -23,7 +24,7 @@ private:
 
     Character chr_;
 
-    SimpleCircuitBuilder builder_;
+    std::shared_ptr<PartitionBuilder> builder_;
 
     util::IndependentOracle oracle_;
 
@@ -57,19 +58,7 @@ private:
     inline void update_bit_map(const std::vector<util::xor_func>& original,
                                const std::vector<util::xor_func>& result)
     {
-        std::set<int> used_bit_index_set;
-        for (size_t i = 0; i < original.size(); i++)
-        {
-            for (size_t j = 0; j < result.size(); j++)
-            {
-                if (!used_bit_index_set.count(j) && original[i] == result[j])
-                {
-                    bit_map_[i] = j;
-                    used_bit_index_set.insert(j);
-                    break;
-                }
-            }
-        }
+        util::match_parities(original, result, bit_map_);
     }
 
 public:
@@ -85,12 +74,12 @@ public:
                                           chr.num_data_qubit(),
                                           chr.num_data_qubit() + chr.num_hadamard());
 
-        builder_ = SimpleCircuitBuilder(option,
-                                        layout,
-                                        chr.num_qubit(),
-                                        chr.num_data_qubit() + chr.num_hadamard(),
-                                        chr.qubit_names(),
-                                        chr.phase_exponents());
+        builder_ = CircuitBuilderFactory().create_simple(option,
+                                                         layout,
+                                                         chr.num_qubit(),
+                                                         chr.num_data_qubit() + chr.num_hadamard(),
+                                                         chr.qubit_names(),
+                                                         chr.phase_exponents());
     }
 
     void init(const Character& chr);
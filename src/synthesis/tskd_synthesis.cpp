@@ -1,4 +1,5 @@
 #include <iomanip>
+#include <algorithm>
 
 #include "tskd_synthesis.hpp"
 
@@ -8,7 +9,6 @@ void TskdSynthesis::init(const Character& chr)
 {
     global_phase_ = 0;
     index_list_.resize(2);
-    carry_index_list_.resize(2);
     remaining_.resize(2);
 
     /*
@@ -47,45 +47,65 @@ void TskdSynthesis::init(const Character& chr)
         }
         index++;
     }
+
+    init_ready_bucket();
+}
+
+void TskdSynthesis::init_ready_bucket()
+{
+    phase_exponents_ = chr_.phase_exponents();
+
+    const int length = chr_.num_data_qubit() + chr_.num_hadamard() + 1;
+    missing_count_ = std::vector<int>(remaining_.size(), 0);
+    unlocked_by_ = std::vector<std::vector<int>>(length);
+    ready_bucket_ = std::vector<std::multiset<int, ParityLess>>(length + 1,
+                                                                std::multiset<int, ParityLess>(ParityLess{&phase_exponents_}));
+
+    for (size_t i = 0; i < remaining_.size(); i++)
+    {
+        const util::xor_func missing = (~mask_) & phase_exponents_[remaining_[i]].second;
+        for (size_t v = missing.find_first(); v != util::xor_func::npos; v = missing.find_next(v))
+        {
+            unlocked_by_[v].push_back(static_cast<int>(i));
+            missing_count_[i]++;
+        }
+
+        if (missing_count_[i] == 0)
+        {
+            make_ready(remaining_[i]);
+        }
+    }
 }
 
 void TskdSynthesis::determine_apply_phase_set(Character::Hadamard& hadamard)
 {
     /**
-     * sort index of phase exponents
+     * put back the phase exponents the previous sub-circuit did not use
      */
-    remaining_.sort([this](int lhs, int rhs) -> bool {
-                        if (chr_.phase_exponents()[lhs].second.count() == chr_.phase_exponents()[rhs].second.count())
-                        {
-                            return chr_.phase_exponents()[lhs].second < chr_.phase_exponents()[rhs].second;
-                        }
-                        else
-                        {
-                            return chr_.phase_exponents()[lhs].second.count() < chr_.phase_exponents()[rhs].second.count();
-                        }});
+    for (auto&& index : carry_index_list_)
+    {
+        make_ready(index);
+    }
 
+    /**
+     * take every available phase exponent in order of popcount and parity
+     */
     std::list<int> tmp_index_list;
     std::list<int> tmp_carry_index_list;
-    for (auto it = remaining_.begin(); it != remaining_.end();)
+    for (auto&& bucket : ready_bucket_)
     {
-        util::xor_func tmp = (~mask_) & (chr_.phase_exponents()[*it].second);
-        if (tmp.none())
+        for (auto&& index : bucket)
         {
-            auto ti = hadamard.in_.find(*it);
-            if (ti != hadamard.in_.end())
+            if (hadamard.in_.test(index))
             {
-                tmp_index_list.push_back(*it);
+                tmp_index_list.push_back(index);
             }
             else
             {
-                tmp_carry_index_list.push_back(*it);
+                tmp_carry_index_list.push_back(index);
             }
-            it = remaining_.erase(it);
-        }
-        else
-        {
-            it++;
         }
+        bucket.clear();
     }
 
     index_list_ = tmp_index_list;
@@ -95,10 +115,8 @@ void TskdSynthesis::determine_apply_phase_set(Character::Hadamard& hadamard)
 void TskdSynthesis::construct_subcircuit(Character::Hadamard& hadamard)
 {
     std::vector<util::xor_func> original_hadamard_outputs = hadamard.input_wires_parity_;
-    circuit_.add_gate_list(builder_.build(index_list_, carry_index_list_, wires_, hadamard.input_wires_parity_));
+    circuit_.add_gate_list(builder_->build(index_list_, carry_index_list_, wires_, hadamard.input_wires_parity_));
     update_bit_map(original_hadamard_outputs, hadamard.input_wires_parity_);
-
-    remaining_.splice(remaining_.begin(), carry_index_list_);
     for (int i = 0; i < chr_.num_qubit(); i++)
     {
         wires_[i] = hadamard.input_wires_parity_[i];
@@ -112,24 +130,66 @@ void TskdSynthesis::apply_hadamard(const Character::Hadamard& hadamard)
     wires_[hadamard_target].reset();
     wires_[hadamard_target].set(hadamard.previous_qubit_index_);
     mask_.set(hadamard.previous_qubit_index_);
+
+    /*
+     * phase exponents waiting only for the new variable become available
+     */
+    for (auto&& i : unlocked_by_[hadamard.previous_qubit_index_])
+    {
+        if (--missing_count_[i] == 0)
+        {
+            make_ready(remaining_[i]);
+        }
+    }
+    unlocked_by_[hadamard.previous_qubit_index_].clear();
 }
 
 void TskdSynthesis::construct_final_subcircuit()
 {
     std::list<int> none_list;
     std::list<int> final_index_list;
-    for (auto it = remaining_.begin(); it != remaining_.end(); it++)
+    if (chr_.num_hadamard() == 0)
     {
-        final_index_list.push_back(*it);
+        final_index_list.assign(remaining_.begin(), remaining_.end());
+    }
+    else
+    {
+        /*
+         * carried phase exponents first, then the rest in order of popcount and parity
+         */
+        std::vector<int> rest;
+        for (auto&& bucket : ready_bucket_)
+        {
+            rest.insert(rest.end(), bucket.begin(), bucket.end());
+        }
+        for (size_t i = 0; i < remaining_.size(); i++)
+        {
+            if (missing_count_[i] > 0)
+            {
+                rest.push_back(remaining_[i]);
+            }
+        }
+        std::stable_sort(rest.begin(), rest.end(), [this](int lhs, int rhs) -> bool {
+                             if (phase_exponents_[lhs].second.count() == phase_exponents_[rhs].second.count())
+                             {
+                                 return phase_exponents_[lhs].second < phase_exponents_[rhs].second;
+                             }
+                             else
+                             {
+                                 return phase_exponents_[lhs].second.count() < phase_exponents_[rhs].second.count();
+                             }});
+
+        final_index_list.assign(carry_index_list_.begin(), carry_index_list_.end());
+        final_index_list.insert(final_index_list.end(), rest.begin(), rest.end());
     }
 
     std::vector<util::xor_func> outputs = chr_.outputs();
-    circuit_.add_gate_list(builder_.build(final_index_list, none_list, wires_, outputs));
+    circuit_.add_gate_list(builder_->build(final_index_list, none_list, wires_, outputs));
 
     /*
      * Add the global phase
      */
-    circuit_.add_gate_list(builder_.build_global_phase(chr_.num_qubit(), global_phase_, chr_.qubit_names()));
+    circuit_.add_gate_list(build_global_phase(chr_.num_qubit(), global_phase_, chr_.qubit_names()));
 }
 
 Circuit TskdSynthesis::execute()
@@ -158,7 +218,7 @@ Circuit TskdSynthesis::execute()
         /*
          * Check for increases in dimension
          */
-        dimension = builder_.check_dimension(chr_, wires_, dimension);
+        dimension = builder_->check_dimension(chr_, wires_, dimension);
     }
 
     /*
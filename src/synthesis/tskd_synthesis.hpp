@@ -4,6 +4,7 @@
 #include "synthesis.hpp"
 
 #include "greedy_circuit_builder.hpp"
+#include "circuit_builder_factory.hpp"
 
 #include "../util/util.hpp"
 
@@ -14,11 +15,24 @@ namespace tskd {
 class TskdSynthesis : public Synthesis
 {
 private:
+    /**
+     * order of phase exponent indices by their parity
+     */
+    struct ParityLess
+    {
+        const std::vector<util::phase_exponent>* phase_exponents_;
+
+        bool operator()(int lhs, int rhs) const
+        {
+            return (*phase_exponents_)[lhs].second < (*phase_exponents_)[rhs].second;
+        }
+    };
+
     util::Option option_;
 
     Character chr_;
 
-    GreedyCircuitBuilder builder_;
+    std::shared_ptr<PhaseSetBuilder> builder_;
 
     util::IndependentOracle oracle_;
 
@@ -32,7 +46,19 @@ private:
     util::xor_func mask_;
 
     std::vector<util::xor_func> wires_;
-    std::list<int> remaining_;
+    std::vector<int> remaining_;
+
+    std::vector<util::phase_exponent> phase_exponents_;
+    std::vector<int> missing_count_;                          // [i] number of variables remaining_[i] still waits for
+    std::vector<std::vector<int>> unlocked_by_;               // [variable] positions in remaining_ waiting for it
+    std::vector<std::multiset<int, ParityLess>> ready_bucket_; // [popcount] available phase exponent indices
+
+    void init_ready_bucket();
+
+    inline void make_ready(int index)
+    {
+        ready_bucket_[phase_exponents_[index].second.count()].insert(index);
+    }
 
     std::vector<int> bit_map_; // [from] = to
 
@@ -47,19 +73,7 @@ private:
     inline void update_bit_map(const std::vector<util::xor_func>& original,
                                const std::vector<util::xor_func>& result)
     {
-        std::set<int> used_bit_index_set;
-        for (size_t i = 0; i < original.size(); i++)
-        {
-            for (size_t j = 0; j < result.size(); j++)
-            {
-                if (!used_bit_index_set.count(j) && original[i] == result[j])
-                {
-                    bit_map_[i] = j;
-                    used_bit_index_set.insert(j);
-                    break;
-                }
-            }
-        }
+        util::match_parities(original, result, bit_map_);
     }
 
 public:
@@ -75,13 +89,13 @@ public:
                                           chr.num_data_qubit(),
                                           chr.num_data_qubit() + chr.num_hadamard());
 
-        builder_ = GreedyCircuitBuilder(option,
-                                        layout,
-                                        oracle_,
-                                        chr.num_qubit(),
-                                        chr.num_data_qubit() + chr.num_hadamard(),
-                                        chr.qubit_names(),
-                                        chr.phase_exponents());
+        builder_ = CircuitBuilderFactory().create_greedy(option,
+                                                         layout,
+                                                         oracle_,
+                                                         chr.num_qubit(),
+                                                         chr.num_data_qubit() + chr.num_hadamard(),
+                                                         chr.qubit_names(),
+                                                         chr.phase_exponents());
     }
 
     void init(const Character& chr);
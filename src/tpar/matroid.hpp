@@ -142,6 +142,73 @@ void add_to_partition(partitioning& ret,
 
 }
 
+// Check whether an element can join a partition, using the partition's cached basis
+template<class T, typename oracle_type>
+bool fits_partition(partition& S,
+                    int i,
+                    const std::vector <T>& elts,
+                    const oracle_type& oracle)
+{
+    const int new_size = static_cast<int>(S.size()) + 1;
+    if (oracle.is_rank_free(new_size))
+    {
+        return true;
+    }
+
+    const int length = oracle.length();
+
+    return oracle(new_size, S.rank(elts, length) + (S.spans(elts, length, i) ? 0 : 1));
+}
+
+// Add a batch of elements to the partition. A greedy first-fit packing places
+//   what it can, opening partitions only up to the lower bound given by the
+//   maximum partition size; the augmenting-path search then runs only for the
+//   elements greedy could not place
+template<class T, typename oracle_type>
+void add_to_partition_bulk(partitioning& ret,
+                           const std::list<int>& lst,
+                           const std::vector <T>& elts,
+                           const oracle_type& oracle)
+{
+    partitioning::iterator Si;
+    std::list<int> rest;
+
+    const int total = num_elts(ret) + static_cast<int>(lst.size());
+    const int lower_bound = oracle.num() > 0 ? (total + oracle.num() - 1) / oracle.num() : 0;
+
+    for (auto it = lst.begin(); it != lst.end(); it++)
+    {
+        bool flag = false;
+        for (Si = ret.begin(); Si != ret.end() && !flag; Si++)
+        {
+            if (fits_partition(*Si, *it, elts, oracle))
+            {
+                Si->insert(*it);
+                flag = true;
+            }
+        }
+
+        if (!flag)
+        {
+            if (static_cast<int>(ret.size()) < lower_bound)
+            {
+                std::set<int> newset;
+                newset.insert(*it);
+                ret.push_front(newset);
+            }
+            else
+            {
+                rest.push_back(*it);
+            }
+        }
+    }
+
+    for (auto it = rest.begin(); it != rest.end(); it++)
+    {
+        add_to_partition(ret, *it, elts, oracle);
+    }
+}
+
 // Partition the matroid
 template<class T, typename oracle_type>
 partitioning partition_matroid(const std::vector<T>& elts,
@@ -186,6 +253,40 @@ void repartition(partitioning& part, const
     }
 }
 
+// Repartition according to a new oracle, as repartition does; the cached basis
+//   of each partition skips the linearly independent ones, which have nothing
+//   to give up, so only the others are eliminated again
+template<class T, typename oracle_type>
+void repartition_incremental(partitioning& part,
+                             const std::vector <T>& elts,
+                             const oracle_type& oracle)
+{
+    const int length = oracle.length();
+    partitioning::iterator Si;
+    std::list<int> acc;
+
+    for (Si = part.begin(); Si != part.end(); Si++)
+    {
+        if (Si->dependent_elt(elts, length) == -1)
+        {
+            continue;
+        }
+
+        // the element repartition would take out
+        const int tmp = oracle.retrieve_lin_dep(elts, *Si);
+        if (tmp != -1)
+        {
+            Si->erase(tmp);
+            acc.push_back(tmp);
+        }
+    }
+
+    for (auto it = acc.begin(); it != acc.end(); it++)
+    {
+        add_to_partition(part, *it, elts, oracle);
+    }
+}
+
 }
 }
 
@@ -1,30 +1,112 @@
+#include <algorithm>
+
 #include "partition.hpp"
 
 namespace tskd {
 namespace tpar {
 
-template<typename T>
-bool is_disjoint(const std::set <T>& A, const std::set <T>& B)
+void partition::forget(int i)
 {
-    typename std::set<T>::iterator itA = A.begin(), itB = B.begin();
+    mask_.reset(i);
+
+    if (!basis_valid_)
+    {
+        return;
+    }
+
+    auto pi = std::find(pending_.begin(), pending_.end(), i);
+    if (pi != pending_.end())
+    {
+        pending_.erase(pi);
+        return;
+    }
+
+    auto di = std::find(dependents_.begin(), dependents_.end(), i);
+    if (di != dependents_.end())
+    {
+        // the basis does not depend on i
+        dependents_.erase(di);
+        return;
+    }
 
-    while (itA != A.end() && itB != B.end())
+    // i is a basis element, rebuild on the next query
+    basis_valid_ = false;
+}
+
+bool partition::reduce(util::xor_func& parity) const
+{
+    // each row has its pivot cleared in every later row, so one pass in order is enough
+    for (auto&& row : basis_)
     {
-        if (*itA == *itB)
+        if (parity.test(row.find_first()))
         {
-            return false;
+            parity ^= row;
         }
-        else if (*itA < *itB)
+    }
+
+    return parity.any();
+}
+
+void partition::sync(const std::vector<util::phase_exponent>& elts,
+                     int length)
+{
+    if (!basis_valid_)
+    {
+        basis_.clear();
+        dependents_.clear();
+        pending_.assign(begin(), end());
+        basis_valid_ = true;
+    }
+
+    for (auto&& i : pending_)
+    {
+        util::xor_func parity = elts[i].second;
+        if (static_cast<int>(parity.size()) > length)
+        {
+            parity.reset(length);
+        }
+
+        if (reduce(parity))
         {
-            itA++;
+            basis_.push_back(std::move(parity));
         }
         else
         {
-            itB++;
+            dependents_.push_back(i);
         }
     }
+    pending_.clear();
+}
+
+int partition::rank(const std::vector<util::phase_exponent>& elts,
+                    int length)
+{
+    sync(elts, length);
+
+    return static_cast<int>(basis_.size());
+}
+
+bool partition::spans(const std::vector<util::phase_exponent>& elts,
+                      int length,
+                      int i)
+{
+    sync(elts, length);
+
+    util::xor_func parity = elts[i].second;
+    if (static_cast<int>(parity.size()) > length)
+    {
+        parity.reset(length);
+    }
+
+    return !reduce(parity);
+}
+
+int partition::dependent_elt(const std::vector<util::phase_exponent>& elts,
+                             int length)
+{
+    sync(elts, length);
 
-    return true;
+    return dependents_.empty() ? -1 : dependents_.front();
 }
 
 std::ostream& operator<<(std::ostream& output, const partitioning& part)
@@ -47,14 +129,14 @@ std::ostream& operator<<(std::ostream& output, const partitioning& part)
 
 // Take a partition and a set of ints, and return all partitions that are not
 //   disjoint with the set, also removing them from the partition
-partitioning freeze_partitions(partitioning& part, std::set<int>& st)
+partitioning freeze_partitions(partitioning& part, const util::index_set& st)
 {
     partitioning ret;
     partitioning::iterator it, tmp;
 
     for (it = part.begin(); it != part.end();)
     {
-        if (!is_disjoint(*it, st))
+        if (it->intersects(st))
         {
             tmp = it;
             it++;
@@ -3,19 +3,163 @@
 
 #include <list>
 #include <set>
+#include <vector>
 #include <iostream>
 
+#include "../util/util.hpp"
+
 namespace tskd {
 namespace tpar {
 
-using partitioning = std::list<std::set<int>>;
+/**
+ * set of phase exponent indices that keeps an echelon basis of their parities
+ * the basis is updated lazily: inserted elements are reduced on the next query,
+ * erasing an element outside of the basis keeps it valid, erasing a basis element drops it
+ */
+class partition : public std::set<int>
+{
+private:
+    bool basis_valid_ = false;
+
+    std::vector<util::xor_func> basis_; // reduced rows, each with a distinct pivot
+    std::list<int> dependents_;         // elements in the span of the basis
+    std::list<int> pending_;            // elements inserted since the last sync
+
+    util::index_set mask_;              // bitset mirror of the elements
+
+    void sync(const std::vector<util::phase_exponent>& elts,
+              int length);
+
+    bool reduce(util::xor_func& parity) const;
+
+    void forget(int i);
+
+    inline void mark(int i)
+    {
+        if (i >= static_cast<int>(mask_.size()))
+        {
+            mask_.resize(i + 1);
+        }
+        mask_.set(i);
+    }
+
+public:
+    partition() = default;
+
+    partition(const std::set<int>& st)
+            : std::set<int>(st)
+    {
+        for (auto&& i : st)
+        {
+            mark(i);
+        }
+    }
+
+    std::pair<iterator, bool> insert(int i)
+    {
+        auto ret = std::set<int>::insert(i);
+        if (ret.second)
+        {
+            mark(i);
+            if (basis_valid_)
+            {
+                pending_.push_back(i);
+            }
+        }
+
+        return ret;
+    }
+
+    iterator insert(const_iterator hint,
+                    int i)
+    {
+        const size_t old_size = size();
+        auto ret = std::set<int>::insert(hint, i);
+        if (size() != old_size)
+        {
+            mark(i);
+            if (basis_valid_)
+            {
+                pending_.push_back(i);
+            }
+        }
+
+        return ret;
+    }
+
+    size_type erase(int i)
+    {
+        const size_type ret = std::set<int>::erase(i);
+        if (ret)
+        {
+            forget(i);
+        }
+
+        return ret;
+    }
+
+    iterator erase(const_iterator it)
+    {
+        const int i = *it;
+        auto ret = std::set<int>::erase(it);
+        forget(i);
+
+        return ret;
+    }
+
+    /**
+     * check whether this partition shares an element with an index set
+     * @param st index set
+     * @return whether the intersection is not empty
+     */
+    bool intersects(const util::index_set& st)
+    {
+        if (mask_.size() != st.size())
+        {
+            mask_.resize(st.size());
+        }
+
+        return mask_.intersects(st);
+    }
+
+    /**
+     * return rank of the parities of this partition
+     * @param elts phase exponents
+     * @param length number of variables the rank is computed over
+     * @return rank
+     */
+    int rank(const std::vector<util::phase_exponent>& elts,
+             int length);
+
+    /**
+     * check whether the parity of an element is spanned by this partition
+     * @param elts phase exponents
+     * @param length number of variables the rank is computed over
+     * @param i element index
+     * @return whether adding i keeps the rank
+     */
+    bool spans(const std::vector<util::phase_exponent>& elts,
+               int length,
+               int i);
+
+    /**
+     * return an element whose removal keeps the rank, or -1 when the partition is linearly independent
+     * @param elts phase exponents
+     * @param length number of variables the rank is computed over
+     * @return element index
+     */
+    int dependent_elt(const std::vector<util::phase_exponent>& elts,
+                      int length);
+};
+
+using partitioning = std::list<partition>;
 using path_iterator = std::list<std::pair<int, partitioning::iterator>>::iterator;
 
 std::ostream& operator<<(std::ostream& output,
                          const partitioning& part);
 
 partitioning freeze_partitions(partitioning& part,
-                               std::set<int>& st);
+                               const util::index_set& st);
 
 int num_elts(partitioning& part);
 
@@ -24,4 +168,4 @@ partitioning create(std::set<int>& st);
 }
 }
 
-#endif //T_SCHEDULING_PARTITION_HPP
\ No newline at end of file
+#endif //T_SCHEDULING_PARTITION_HPP
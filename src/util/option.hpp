@@ -3,6 +3,9 @@
 
 #include <iostream>
 #include <string>
+#include <memory>
+
+#include "sa_budget.hpp"
 
 enum SynthesisMethod
 {
@@ -13,7 +16,27 @@ enum SynthesisMethod
 enum DecompositionType
 {
     kgauss,
-    kparallel
+    kparallel,
+    kpmh,
+    ksteiner
+};
+
+enum ReorderCost
+{
+    kcount, // cnots of Gauss-Jordan elimination
+    klayer  // cnot layers under the data qubit placement
+};
+
+enum OracleEncoding
+{
+    kinteger, // integer edge and label variables, arithmetic degree sums
+    kboolean  // boolean edges with cardinality constraints, bit-vector labels
+};
+
+enum OracleBackendType
+{
+    ksat, // in-tree CDCL solver
+    kz3   // Z3, when built with it
 };
 
 namespace tskd {
@@ -32,6 +55,27 @@ private:
 
     bool change_row_order_;
 
+    bool bulk_partition_ = false;
+
+    int num_thread_ = 1;
+
+    int num_sa_chain_ = 1;
+
+    long sa_time_ = 0;      // total row reordering time of the run in ms, 0: 200 ms per call
+    long sa_iteration_ = 0; // moves per chain and call, 0: bounded by time
+    long sa_patience_ = 0;  // moves without improvement before a chain stops, 0: never
+    long sa_seed_ = -1;     // -1: random seed
+
+    bool sa_cache_ = true;  // reuse row orders of matrices already reordered
+
+    ReorderCost sa_cost_ = ReorderCost::kcount;
+
+    OracleEncoding oracle_encoding_ = OracleEncoding::kinteger; // of the Z3 backend
+
+    OracleBackendType oracle_backend_ = OracleBackendType::ksat;
+
+    std::shared_ptr<SABudget> sa_budget_; // shared by the copies of this option
+
     SynthesisMethod syn_method_;
     DecompositionType dec_type_;
 
@@ -91,6 +135,66 @@ public:
         return change_row_order_;
     }
 
+    bool bulk_partition() const
+    {
+        return bulk_partition_;
+    }
+
+    int num_thread() const
+    {
+        return num_thread_;
+    }
+
+    int num_sa_chain() const
+    {
+        return num_sa_chain_;
+    }
+
+    long sa_time() const
+    {
+        return sa_time_;
+    }
+
+    long sa_iteration() const
+    {
+        return sa_iteration_;
+    }
+
+    long sa_patience() const
+    {
+        return sa_patience_;
+    }
+
+    long sa_seed() const
+    {
+        return sa_seed_;
+    }
+
+    bool sa_cache() const
+    {
+        return sa_cache_;
+    }
+
+    ReorderCost sa_cost() const
+    {
+        return sa_cost_;
+    }
+
+    OracleEncoding oracle_encoding() const
+    {
+        return oracle_encoding_;
+    }
+
+    OracleBackendType oracle_backend() const
+    {
+        return oracle_backend_;
+    }
+
+    std::shared_ptr<SABudget> sa_budget() const
+    {
+        return sa_budget_;
+    }
+
     SynthesisMethod syn_method() const
     {
         return syn_method_;
@@ -132,6 +236,69 @@ public:
         change_row_order_ = change_row_order;
     }
 
+    void set_bulk_partition(bool bulk_partition)
+    {
+        bulk_partition_ = bulk_partition;
+    }
+
+    void set_num_thread(int num_thread)
+    {
+        num_thread_ = num_thread;
+    }
+
+    void set_num_sa_chain(int num_sa_chain)
+    {
+        num_sa_chain_ = num_sa_chain;
+    }
+
+    void set_sa_time(long sa_time)
+    {
+        sa_time_ = sa_time;
+    }
+
+    void set_sa_iteration(long sa_iteration)
+    {
+        sa_iteration_ = sa_iteration;
+    }
+
+    void set_sa_patience(long sa_patience)
+    {
+        sa_patience_ = sa_patience;
+    }
+
+    void set_sa_seed(long sa_seed)
+    {
+        sa_seed_ = sa_seed;
+    }
+
+    void set_sa_cache(bool sa_cache)
+    {
+        sa_cache_ = sa_cache;
+    }
+
+    void set_sa_cost(const ReorderCost& sa_cost)
+    {
+        sa_cost_ = sa_cost;
+    }
+
+    void set_oracle_encoding(const OracleEncoding& oracle_encoding)
+    {
+        oracle_encoding_ = oracle_encoding;
+    }
+
+    void set_oracle_backend(const OracleBackendType& oracle_backend)
+    {
+        oracle_backend_ = oracle_backend;
+    }
+
+    /**
+     * create the budget shared by the row reordering calls from the sa_* settings
+     */
+    void init_sa_budget()
+    {
+        sa_budget_ = std::make_shared<SABudget>(sa_time_, sa_iteration_, sa_patience_, sa_seed_);
+    }
+
     void set_syn_method(const SynthesisMethod& syn_method)
     {
         syn_method_ = syn_method;
@@ -161,6 +328,44 @@ public:
                 break;
         }
         std::cout << "# change row order: " << std::boolalpha << change_row_order_ << std::endl;
+        std::cout << "# bulk partition: " << std::boolalpha << bulk_partition_ << std::endl;
+        std::cout << "# number of thread: " << num_thread_ << std::endl;
+        std::cout << "# number of sa chain: " << num_sa_chain_ << std::endl;
+        std::cout << "# sa total time [ms]: " << sa_time_ << std::endl;
+        std::cout << "# sa iteration: " << sa_iteration_ << std::endl;
+        std::cout << "# sa patience: " << sa_patience_ << std::endl;
+        std::cout << "# sa seed: " << sa_seed_ << std::endl;
+        std::cout << "# sa cache: " << std::boolalpha << sa_cache_ << std::endl;
+        std::cout << "# sa cost: ";
+        switch (sa_cost_)
+        {
+            case ReorderCost::kcount:
+                std::cout << "count" << std::endl;
+                break;
+            case ReorderCost::klayer:
+                std::cout << "layer" << std::endl;
+                break;
+        }
+        std::cout << "# oracle encoding: ";
+        switch (oracle_encoding_)
+        {
+            case OracleEncoding::kinteger:
+                std::cout << "int" << std::endl;
+                break;
+            case OracleEncoding::kboolean:
+                std::cout << "bool" << std::endl;
+                break;
+        }
+        std::cout << "# oracle backend: ";
+        switch (oracle_backend_)
+        {
+            case OracleBackendType::ksat:
+                std::cout << "sat" << std::endl;
+                break;
+            case OracleBackendType::kz3:
+                std::cout << "z3" << std::endl;
+                break;
+        }
         std::cout << "# decomposition type: ";
         switch (dec_type_)
         {
@@ -170,6 +375,12 @@ public:
             case DecompositionType::kparallel:
                 std::cout << "parallel" << std::endl;
                 break;
+            case DecompositionType::kpmh:
+                std::cout << "pmh" << std::endl;
+                break;
+            case DecompositionType::ksteiner:
+                std::cout << "steiner" << std::endl;
+                break;
         }
     }
 };
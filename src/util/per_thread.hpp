@@ -0,0 +1,63 @@
+#ifndef T_SCHEDULING_PER_THREAD_HPP
+#define T_SCHEDULING_PER_THREAD_HPP
+
+#include <vector>
+#include <memory>
+#include <utility>
+
+namespace tskd {
+namespace util {
+
+/**
+ * one instance of T per thread, made on the first get() of the thread
+ * the instances sit in thread_local storage, so get() takes no lock
+ * copies share the instances, as a thread uses one of them at a time;
+ * an instance goes with its thread, or with a later get() of the thread
+ * once every copy is gone
+ * @tparam T working state
+ */
+template<typename T>
+class PerThread
+{
+private:
+    using Slot = std::pair<std::weak_ptr<const char>, std::unique_ptr<T>>;
+
+    std::shared_ptr<const char> key_ = std::make_shared<const char>(0);
+
+public:
+    PerThread() = default;
+
+    /**
+     * instance of the calling thread
+     * @param make returns a std::unique_ptr<T> for a thread without one
+     * @return instance
+     */
+    template<typename Make>
+    T& get(Make make) const
+    {
+        static thread_local std::vector<Slot> slot_list;
+
+        for (auto it = slot_list.begin(); it != slot_list.end();)
+        {
+            if (it->first.expired())
+            {
+                it = slot_list.erase(it);
+
+                continue;
+            }
+            if (!it->first.owner_before(key_) && !key_.owner_before(it->first))
+            {
+                return *it->second;
+            }
+            ++it;
+        }
+        slot_list.emplace_back(key_, make());
+
+        return *slot_list.back().second;
+    }
+};
+
+}
+}
+
+#endif //T_SCHEDULING_PER_THREAD_HPP
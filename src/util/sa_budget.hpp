@@ -0,0 +1,109 @@
+#ifndef T_SCHEDULING_SA_BUDGET_HPP
+#define T_SCHEDULING_SA_BUDGET_HPP
+
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+
+namespace tskd {
+namespace util {
+
+/**
+ * optimisation budget shared by every row reordering call of a run
+ * a total time is split across calls in proportion to n^2 of their matrices;
+ * as the number of calls is not known in advance, each call assumes that as
+ * many calls as already made (plus reserve_call) are still to come, so early
+ * calls get larger shares and the sum never exceeds the total
+ */
+class SABudget
+{
+private:
+    std::mutex mutex_;
+
+    std::chrono::milliseconds total_time_; // 0: every call gets its default time
+    std::chrono::milliseconds remaining_time_;
+
+    long num_iteration_; // moves per chain and call, 0: bounded by time
+    long patience_;      // stop a chain after this many moves without improvement, 0: never
+    long seed_;          // -1: seed from std::random_device
+
+    double done_weight_;
+
+public:
+    static constexpr int reserve_call = 8;
+
+    /**
+     * constructor
+     * @param total_time total time of the run in ms, 0 for the per-call default
+     * @param num_iteration moves per chain and call, 0 to bound by time
+     * @param patience moves without improvement before a chain stops, 0 for never
+     * @param seed seed of the reconstructors, -1 for a random seed
+     */
+    SABudget(long total_time,
+             long num_iteration,
+             long patience,
+             long seed)
+            : total_time_(total_time),
+              remaining_time_(total_time),
+              num_iteration_(num_iteration),
+              patience_(patience),
+              seed_(seed),
+              done_weight_(0) { }
+
+    long num_iteration() const
+    {
+        return num_iteration_;
+    }
+
+    long patience() const
+    {
+        return patience_;
+    }
+
+    long seed() const
+    {
+        return seed_;
+    }
+
+    /**
+     * time granted to the next call
+     * @param size number of rows of its matrix
+     * @param default_time time of a call when there is no total budget
+     * @return granted time
+     */
+    std::chrono::milliseconds request(int size,
+                                      std::chrono::milliseconds default_time)
+    {
+        if (total_time_.count() == 0)
+        {
+            return default_time;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        const double weight = static_cast<double>(size) * size;
+        const double share = weight / (weight + done_weight_ + reserve_call * weight);
+        done_weight_ += weight;
+
+        return std::chrono::milliseconds(static_cast<long>(remaining_time_.count() * share));
+    }
+
+    /**
+     * charge the time a call actually used
+     * @param used elapsed time of the call
+     */
+    void release(std::chrono::milliseconds used)
+    {
+        if (total_time_.count() == 0)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        remaining_time_ = std::max(std::chrono::milliseconds(0), remaining_time_ - used);
+    }
+};
+
+}
+}
+
+#endif //T_SCHEDULING_SA_BUDGET_HPP
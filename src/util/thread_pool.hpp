@@ -0,0 +1,123 @@
+#ifndef T_SCHEDULING_THREAD_POOL_HPP
+#define T_SCHEDULING_THREAD_POOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace tskd {
+namespace util {
+
+/**
+ * fixed set of worker threads that run batches of indexed tasks
+ */
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable task_cv_;
+    std::condition_variable done_cv_;
+
+    std::function<void(int)> task_;
+    int num_task_;
+    int next_task_;
+    int num_done_;
+    bool stop_;
+
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            task_cv_.wait(lock, [this] { return stop_ || next_task_ < num_task_; });
+            if (stop_)
+            {
+                return;
+            }
+
+            const int index = next_task_++;
+            lock.unlock();
+            task_(index);
+            lock.lock();
+
+            if (++num_done_ == num_task_)
+            {
+                done_cv_.notify_one();
+            }
+        }
+    }
+
+public:
+    /**
+     * constructor
+     * @param num_thread number of worker threads
+     */
+    explicit ThreadPool(int num_thread)
+            : num_task_(0),
+              next_task_(0),
+              num_done_(0),
+              stop_(false)
+    {
+        for (int i = 0; i < num_thread; i++)
+        {
+            workers_.emplace_back(&ThreadPool::work, this);
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        task_cv_.notify_all();
+        for (auto&& worker : workers_)
+        {
+            worker.join();
+        }
+    }
+
+    /**
+     * return number of worker threads
+     * @return number of threads
+     */
+    int size() const
+    {
+        return static_cast<int>(workers_.size());
+    }
+
+    /**
+     * run task(0), ..., task(num_task - 1) on the workers and wait for all of them
+     * @param num_task number of tasks
+     * @param task task taking its index
+     */
+    void run(int num_task,
+             const std::function<void(int)>& task)
+    {
+        if (num_task == 0)
+        {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        task_ = task;
+        num_task_ = num_task;
+        next_task_ = 0;
+        num_done_ = 0;
+        task_cv_.notify_all();
+        done_cv_.wait(lock, [this] { return num_done_ == num_task_; });
+    }
+};
+
+}
+}
+
+#endif //T_SCHEDULING_THREAD_POOL_HPP
@@ -1,4 +1,6 @@
 #include <map>
+#include <unordered_map>
+#include <boost/functional/hash.hpp>
 
 #include "util.hpp"
 
@@ -195,6 +197,39 @@ bool is_independent(int num_qubit,
     return is_independent_destructive(num_qubit, bits, temp_parity);
 }
 
+void match_parities(const std::vector<xor_func>& original,
+                    const std::vector<xor_func>& result,
+                    std::vector<int>& bit_map)
+{
+    // chain the indices of equal parities in increasing order
+    std::unordered_map<xor_func, int, boost::hash<xor_func>> head;
+    std::vector<int> next(result.size(), -1);
+    head.reserve(result.size());
+    for (int j = static_cast<int>(result.size()) - 1; j >= 0; j--)
+    {
+        auto it = head.find(result[j]);
+        if (it == head.end())
+        {
+            head.emplace(result[j], j);
+        }
+        else
+        {
+            next[j] = it->second;
+            it->second = j;
+        }
+    }
+
+    for (size_t i = 0; i < original.size(); i++)
+    {
+        auto it = head.find(original[i]);
+        if (it != head.end() && it->second != -1)
+        {
+            bit_map[i] = it->second;
+            it->second = next[it->second];
+        }
+    }
+}
+
 std::list<Gate> to_upper_echelon(int m,
                                  int n,
                                  std::vector<xor_func>& bits,
@@ -305,14 +340,23 @@ std::list<Gate> fix_basis(int m,
                           std::vector<xor_func>& snd,
                           std::vector<xor_func>* mat,
                           const std::vector<std::string>& qubit_names) {
+    std::vector<int> pivots;
+
+    return fix_basis(m, n, k, fst, snd, mat, qubit_names, pivots);
+}
+
+std::list<Gate> fix_basis(int m,
+                          int n,
+                          int k,
+                          const std::vector<xor_func>& fst,
+                          std::vector<xor_func>& snd,
+                          std::vector<xor_func>* mat,
+                          const std::vector<std::string>& qubit_names,
+                          std::vector<int>& pivots) {
     std::list<Gate> acc;
     int j = 0;
     bool flg = false;
-    std::map<int, int> pivots;  // mapping from columns to rows that have that column as pivot
-    for (int i = 0; i < n; i++)
-    {
-        pivots[i] = -1;
-    }
+    pivots.assign(n, -1);  // mapping from columns to rows that have that column as pivot
 
     // First pass makes sure tmp has the same pivots as fst
     for (int i = 0; i < m; i++)
@@ -409,6 +453,14 @@ void compose(int num,
              const std::vector<xor_func>& B)
 {
     auto tmp = std::vector<xor_func>(num);
+    compose(num, A, B, tmp);
+}
+
+void compose(int num,
+             std::vector<xor_func>& A,
+             const std::vector<xor_func>& B,
+             std::vector<xor_func>& tmp)
+{
     for (int i = 0; i < num; i++) {
         tmp[i] = B[i];
     }
@@ -416,6 +468,36 @@ void compose(int num,
     to_lower_echelon(num, num, tmp, &A, std::vector<std::string>());
 }
 
+void multiply(int num,
+              std::vector<xor_func>& A,
+              const std::vector<xor_func>& B)
+{
+    auto tmp = std::vector<xor_func>(num);
+    multiply(num, A, B, tmp);
+    A = std::move(tmp);
+}
+
+void multiply(int num,
+              const std::vector<xor_func>& A,
+              const std::vector<xor_func>& B,
+              std::vector<xor_func>& out)
+{
+    for (int i = 0; i < num; i++)
+    {
+        out[i].resize(A[i].size());
+        out[i].reset();
+        for (size_t k = B[i].find_first(); k < static_cast<size_t>(num); k = B[i].find_next(k))
+        {
+            out[i] ^= A[k];
+        }
+        // affine part of B
+        if (B[i].test(num))
+        {
+            out[i].flip(num);
+        }
+    }
+}
+
 std::list<Gate> compose_x(int target,
                           const std::vector<std::string>& qubit_names)
 {
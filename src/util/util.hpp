@@ -12,6 +12,7 @@ namespace util {
 
 using xor_func = boost::dynamic_bitset<>;
 using phase_exponent = std::pair<int, xor_func>;
+using index_set = boost::dynamic_bitset<>; // bit i is set when phase exponent i is a member
 
 using gate_list = std::list<Gate>;
 
@@ -51,12 +52,45 @@ public:
     bool operator()(const std::vector<phase_exponent>& expnts,
                     const std::set<int>& lst) const;
 
+    /**
+     * matroid oracle for a set whose rank is already known
+     * @param size number of elements in the set
+     * @param rank rank of the set
+     * @return whether the set is independent
+     */
+    bool operator()(int size, int rank) const
+    {
+        return size <= num_ && (size == 1 || (num_ - size) >= (dim_ - rank));
+    }
+
+    /**
+     * check whether a set of this size is independent regardless of its rank
+     * @param size number of elements in the set
+     * @return whether the rank can be skipped
+     */
+    bool is_rank_free(int size) const
+    {
+        return size <= num_ && (size == 1 || (num_ - size) >= dim_);
+    }
+
     /**
      * set new dimension
      * @param newdim new dimension
      */
     void set_dim(int newdim) { dim_ = newdim; }
 
+    /**
+     * return maximum number of elements in an independent set
+     * @return num
+     */
+    int num() const { return num_; }
+
+    /**
+     * return number of variables the rank is computed over
+     * @return length
+     */
+    int length() const { return length_; }
+
     /**
      * Shortcut to find a linearly dependent element faster
      * @param expnts
@@ -111,6 +145,16 @@ bool is_independent(int num_qubit,
                     const std::vector<xor_func>& bits,
                     const xor_func& parity);
 
+/**
+ * match each parity of original with an equal parity of result, lowest unused index first
+ * @param original parities to match
+ * @param result parities to be matched with
+ * @param bit_map [i] = index of result matched with original[i], left as is when there is no match
+ */
+void match_parities(const std::vector<xor_func>& original,
+                    const std::vector<xor_func>& result,
+                    std::vector<int>& bit_map);
+
 std::list<Gate> to_upper_echelon(int m,
                                  int n,
                                  std::vector<xor_func>& bits,
@@ -131,6 +175,18 @@ std::list<Gate> fix_basis(int m,
                           std::vector<xor_func>* mat,
                           const std::vector<std::string>& qubit_names);
 
+/*
+ * same as above, reusing pivots as the pivot table (resized to n)
+ */
+std::list<Gate> fix_basis(int m,
+                          int n,
+                          int k,
+                          const std::vector<xor_func>& fst,
+                          std::vector<xor_func>& snd,
+                          std::vector<xor_func>* mat,
+                          const std::vector<std::string>& qubit_names,
+                          std::vector<int>& pivots);
+
 /*
  * A := B^{-1} A
  */
@@ -138,6 +194,29 @@ void compose(int num,
              std::vector<xor_func>& A,
              const std::vector<xor_func>& B);
 
+/*
+ * A := B^{-1} A, reusing tmp (at least num rows) as the copy of B
+ */
+void compose(int num,
+             std::vector<xor_func>& A,
+             const std::vector<xor_func>& B,
+             std::vector<xor_func>& tmp);
+
+/*
+ * A := B A
+ */
+void multiply(int num,
+              std::vector<xor_func>& A,
+              const std::vector<xor_func>& B);
+
+/*
+ * out := B A, out must already hold num rows
+ */
+void multiply(int num,
+              const std::vector<xor_func>& A,
+              const std::vector<xor_func>& B,
+              std::vector<xor_func>& out);
+
 std::list<Gate> compose_x(int target,
                           const std::vector<std::string>& qubit_names);
 
@@ -0,0 +1,57 @@
+#ifndef T_SCHEDULING_WORKSPACE_HPP
+#define T_SCHEDULING_WORKSPACE_HPP
+
+#include <vector>
+
+#include "util.hpp"
+
+namespace tskd {
+namespace util {
+
+/**
+ * scratch matrices of a circuit builder
+ * sized once and reused across candidates and rounds, so that copy-assigning
+ * rows of the same length never touches the heap
+ */
+struct Workspace
+{
+    std::vector<xor_func> bits;    // parities of a sub part, dimension + 1 columns
+    std::vector<xor_func> matrix;  // matrix to count or decompose, qubit_num + 1 columns
+    std::vector<xor_func> before;  // restoration^-1
+    std::vector<xor_func> after;   // restoration^-1 with rows moved by func_map
+    std::vector<xor_func> scratch; // copy of the right operand of compose
+    std::vector<int> pivots;       // pivot table of fix_basis
+    std::vector<int> func_map;
+
+    Workspace() = default;
+
+    /**
+     * constructor
+     * @param qubit_num number of qubits
+     * @param dimension dimension of the parities
+     */
+    Workspace(int qubit_num, int dimension)
+            : bits(qubit_num, xor_func(dimension + 1, 0)),
+              matrix(qubit_num, xor_func(qubit_num + 1, 0)),
+              before(qubit_num, xor_func(qubit_num + 1, 0)),
+              after(qubit_num, xor_func(qubit_num + 1, 0)),
+              scratch(qubit_num, xor_func(qubit_num + 1, 0)),
+              pivots(dimension, -1),
+              func_map(qubit_num) { }
+
+    /**
+     * reset func_map to the identity
+     */
+    void reset_func_map()
+    {
+        for (size_t i = 0; i < func_map.size(); i++)
+        {
+            func_map[i] = static_cast<int>(i);
+        }
+    }
+};
+
+}
+}
+
+#endif //T_SCHEDULING_WORKSPACE_HPP